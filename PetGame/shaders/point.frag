@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 PointColor;
+
+// Far LOD impostor, one flat colored square per pet with nothing to sample or discard
+void main()
+{
+    FragColor = vec4(PointColor, 1.0);
+}
\ No newline at end of file
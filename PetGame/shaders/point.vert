@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec2 aPosition;
+// Diameter in screen pixels
+layout (location = 1) in float aSize;
+layout (location = 2) in vec3 aColor;
+
+out vec3 PointColor;
+
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 time;
+    vec4 viewport;
+};
+
+void main()
+{
+    gl_Position = projection * view * vec4(aPosition, 0.0, 1.0);
+    gl_PointSize = aSize;
+    PointColor = aColor;
+}
\ No newline at end of file
@@ -2,15 +2,17 @@
 out vec4 FragColor;
 
 in vec2 TextCoord;
+in vec3 SpriteColor;
+flat in float Layer;
 
 uniform sampler2D spriteTexture;
-uniform vec3 spriteColor;
+uniform sampler2DArray spriteFrames;
 
 void main()
 {
    //FragColor = texture(spriteTexture, TextCoord) * vec4(spriteColor, 1.0);
-   vec4 texColor = texture(spriteTexture, TextCoord);
+   vec4 texColor = (Layer < 0.0) ? texture(spriteTexture, TextCoord) : texture(spriteFrames, vec3(TextCoord, Layer));
    if(texColor.a < 0.1) discard;
 
-    FragColor=texColor * vec4(spriteColor,1.f);
+    FragColor=texColor * vec4(SpriteColor,1.f);
 }
\ No newline at end of file
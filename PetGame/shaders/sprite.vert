@@ -1,14 +1,41 @@
 #version 330 core
 layout (location=0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+// Per instance
+// 2D affine transform, xy: scaled x axis, zw: scaled y axis, plus the translation
+layout (location = 2) in vec4 aBasis;
+layout (location = 3) in vec2 aTranslation;
+layout (location = 4) in vec3 aColor;
+// x: ticks in the frame table (0 for static sprites), y: tick duration, z: start time
+layout (location = 5) in vec3 aAnimation;
+// xy: offset, zw: size of the part of the texture to sample, LOD sprites use a cell of the atlas
+layout (location = 6) in vec4 aUvRect;
 
 out vec2 TextCoord;
+out vec3 SpriteColor;
+// Texture array layer to sample, negative for static sprites
+flat out float Layer;
 
-uniform mat4 model;
-uniform mat4 projection;
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec4 time;
+    vec4 viewport;
+};
+
+uniform usampler1D frameTable;
 
 void main()
 {
-    gl_Position = projection * model * vec4(aPos, 1.0);
-    TextCoord = aTexCoord;
+    vec2 worldPos = aBasis.xy * aPos.x + aBasis.zw * aPos.y + aTranslation;
+    gl_Position = projection * view * vec4(worldPos, aPos.z, 1.0);
+    TextCoord = aUvRect.xy + aTexCoord * aUvRect.zw;
+    SpriteColor = aColor;
+
+    Layer = -1.0;
+    if (aAnimation.x > 0.0) {
+        float ticks = floor(max(time.x - aAnimation.z, 0.0) / aAnimation.y);
+        Layer = float(texelFetch(frameTable, int(mod(ticks, aAnimation.x)), 0).r);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "Profiler.h"
+
+namespace PetGame {
+	static const size_t TAG_COUNT = (size_t)AllocationTag::Count;
+	static const char* TAG_NAMES[TAG_COUNT] = { "Untagged", "Sim", "Render", "UI", "Assets" };
+
+#ifdef PETGAME_COUNT_ALLOCATIONS
+	// Put in front of every allocation, offset is the distance from the start of the block to the user pointer
+	struct AllocationHeader {
+		uint64_t size;
+		uint32_t offset;
+		AllocationTag tag;
+	};
+	static const size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+	static const size_t HEADER_SIZE = (sizeof(AllocationHeader) + DEFAULT_ALIGNMENT - 1) / DEFAULT_ALIGNMENT * DEFAULT_ALIGNMENT;
+
+	// Plain atomics and thread locals so the hook works before and after every static constructor
+	struct TagCounters {
+		std::atomic<unsigned long long> count;
+		std::atomic<unsigned long long> bytes;
+		std::atomic<long long> liveBytes;
+	};
+	static TagCounters s_tags[TAG_COUNT];
+	static std::atomic<unsigned long long> s_allocations(0);
+	static std::atomic<long long> s_liveBytes(0);
+	static std::atomic<long long> s_peakLiveBytes(0);
+	static thread_local unsigned long long t_allocations = 0;
+	static thread_local AllocationTag t_tag = AllocationTag::Untagged;
+
+	static ProfilerCounter s_frameCounts[TAG_COUNT] = {
+		{ "Memory/Untagged allocations per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Sim allocations per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Render allocations per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/UI allocations per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Assets allocations per frame", ProfilerCounter::Kind::Gauge },
+	};
+	static ProfilerCounter s_frameBytes[TAG_COUNT] = {
+		{ "Memory/Untagged bytes per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Sim bytes per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Render bytes per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/UI bytes per frame", ProfilerCounter::Kind::Gauge },
+		{ "Memory/Assets bytes per frame", ProfilerCounter::Kind::Gauge },
+	};
+	static ProfilerCounter s_liveBytesCounter("Memory/Live heap bytes", ProfilerCounter::Kind::Gauge);
+	static ProfilerCounter s_peakLiveBytesCounter("Memory/Peak heap bytes", ProfilerCounter::Kind::Gauge);
+
+	// Only touched by the thread calling EndFrame
+	static AllocationStats s_frameStart[TAG_COUNT];
+	static AllocationStats s_lastFrame[TAG_COUNT];
+
+	static void* CountedAllocate(std::size_t size, std::size_t alignment)
+	{
+		size_t offset = (alignment > HEADER_SIZE) ? alignment : HEADER_SIZE;
+		size_t total = offset + ((size > 0) ? size : 1);
+		unsigned char* block;
+#ifdef _MSC_VER
+		block = (unsigned char*)((alignment > DEFAULT_ALIGNMENT) ? _aligned_malloc(total, alignment) : std::malloc(total));
+#else
+		block = (unsigned char*)((alignment > DEFAULT_ALIGNMENT) ? std::aligned_alloc(alignment, (total + alignment - 1) / alignment * alignment) : std::malloc(total));
+#endif
+		if (!block) {
+			return nullptr;
+		}
+
+		AllocationTag tag = t_tag;
+		AllocationHeader* header = (AllocationHeader*)(block + offset - sizeof(AllocationHeader));
+		header->size = size;
+		header->offset = (uint32_t)offset;
+		header->tag = tag;
+
+		TagCounters& counters = s_tags[(size_t)tag];
+		counters.count.fetch_add(1, std::memory_order_relaxed);
+		counters.bytes.fetch_add(size, std::memory_order_relaxed);
+		counters.liveBytes.fetch_add((long long)size, std::memory_order_relaxed);
+		s_allocations.fetch_add(1, std::memory_order_relaxed);
+		t_allocations++;
+
+		long long live = s_liveBytes.fetch_add((long long)size, std::memory_order_relaxed) + (long long)size;
+		long long peak = s_peakLiveBytes.load(std::memory_order_relaxed);
+		while (live > peak && !s_peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+		return block + offset;
+	}
+
+	static void CountedFree(void* memory)
+	{
+		if (!memory) {
+			return;
+		}
+		unsigned char* user = (unsigned char*)memory;
+		const AllocationHeader* header = (const AllocationHeader*)(user - sizeof(AllocationHeader));
+		s_tags[(size_t)header->tag].liveBytes.fetch_sub((long long)header->size, std::memory_order_relaxed);
+		s_liveBytes.fetch_sub((long long)header->size, std::memory_order_relaxed);
+
+		unsigned char* block = user - header->offset;
+#ifdef _MSC_VER
+		if (header->offset > HEADER_SIZE) {
+			_aligned_free(block);
+			return;
+		}
+#endif
+		std::free(block);
+	}
+
+	bool AllocationCounter::isEnabled() { return true; }
+	unsigned long long AllocationCounter::getTotal() { return s_allocations.load(std::memory_order_relaxed); }
+	unsigned long long AllocationCounter::getThreadTotal() { return t_allocations; }
+	long long AllocationCounter::getPeakLiveBytes() { return s_peakLiveBytes.load(std::memory_order_relaxed); }
+
+	AllocationStats AllocationCounter::getStats(AllocationTag tag)
+	{
+		const TagCounters& counters = s_tags[(size_t)tag];
+		AllocationStats stats;
+		stats.count = counters.count.load(std::memory_order_relaxed);
+		stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+		stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void AllocationCounter::EndFrame()
+	{
+		for (size_t i = 0; i < TAG_COUNT; i++) {
+			AllocationStats now = getStats((AllocationTag)i);
+			s_lastFrame[i].count = now.count - s_frameStart[i].count;
+			s_lastFrame[i].bytes = now.bytes - s_frameStart[i].bytes;
+			s_lastFrame[i].liveBytes = now.liveBytes;
+			s_frameStart[i] = now;
+			s_frameCounts[i].Set((long long)s_lastFrame[i].count);
+			s_frameBytes[i].Set((long long)s_lastFrame[i].bytes);
+		}
+		s_liveBytesCounter.Set(s_liveBytes.load(std::memory_order_relaxed));
+		s_peakLiveBytesCounter.Set(getPeakLiveBytes());
+	}
+
+	AllocationStats AllocationCounter::getLastFrame(AllocationTag tag)
+	{
+		return s_lastFrame[(size_t)tag];
+	}
+
+	AllocationScope::AllocationScope(AllocationTag tag)
+		: m_previous(t_tag)
+	{
+		t_tag = tag;
+	}
+
+	AllocationScope::~AllocationScope()
+	{
+		t_tag = m_previous;
+	}
+#else
+	bool AllocationCounter::isEnabled() { return false; }
+	unsigned long long AllocationCounter::getTotal() { return 0; }
+	unsigned long long AllocationCounter::getThreadTotal() { return 0; }
+	long long AllocationCounter::getPeakLiveBytes() { return 0; }
+	AllocationStats AllocationCounter::getStats(AllocationTag tag) { return AllocationStats(); }
+	void AllocationCounter::EndFrame() {}
+	AllocationStats AllocationCounter::getLastFrame(AllocationTag tag) { return AllocationStats(); }
+
+	AllocationScope::AllocationScope(AllocationTag tag) : m_previous(AllocationTag::Untagged) {}
+	AllocationScope::~AllocationScope() {}
+#endif
+
+	const char* AllocationCounter::getTagName(AllocationTag tag)
+	{
+		return ((size_t)tag < TAG_COUNT) ? TAG_NAMES[(size_t)tag] : "Unknown";
+	}
+}
+
+#ifdef PETGAME_COUNT_ALLOCATIONS
+static void* AllocateOrThrow(std::size_t size, std::size_t alignment)
+{
+	void* memory = PetGame::CountedAllocate(size, alignment);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, PetGame::DEFAULT_ALIGNMENT); }
+void* operator new[](std::size_t size) { return AllocateOrThrow(size, PetGame::DEFAULT_ALIGNMENT); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return AllocateOrThrow(size, (std::size_t)alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return AllocateOrThrow(size, (std::size_t)alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return PetGame::CountedAllocate(size, PetGame::DEFAULT_ALIGNMENT); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return PetGame::CountedAllocate(size, PetGame::DEFAULT_ALIGNMENT); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return PetGame::CountedAllocate(size, (std::size_t)alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return PetGame::CountedAllocate(size, (std::size_t)alignment); }
+
+// The header knows how the block was allocated, the size and alignment arguments are not needed
+void operator delete(void* memory) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory) noexcept { PetGame::CountedFree(memory); }
+void operator delete(void* memory, std::size_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { PetGame::CountedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { PetGame::CountedFree(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { PetGame::CountedFree(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { PetGame::CountedFree(memory); }
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+
+namespace PetGame {
+	/* Subsystem an allocation is charged to, chosen per thread with AllocationScope*/
+	enum class AllocationTag : uint8_t {
+		Untagged,
+		Sim,
+		Render,
+		UI,
+		Assets,
+		Count,
+	};
+
+	struct AllocationStats {
+		unsigned long long count = 0;
+		unsigned long long bytes = 0;
+		/* Bytes allocated under the tag and not freed yet*/
+		long long liveBytes = 0;
+	};
+
+	/*
+		Counts heap allocations through a replacement of the global operator new, built in with the
+		PETGAME_COUNT_ALLOCATIONS option. Without it isEnabled is false and every count stays zero.
+		Every allocation is charged to the tag of the innermost AllocationScope of its thread and
+		carries a small header, so freeing it is charged back to the same tag whatever thread frees it.
+		Counting is a few relaxed atomics, cheap enough to leave on in development builds.
+	*/
+	class AllocationCounter
+	{
+	public:
+		static bool isEnabled();
+		/* Allocations since the start of the process, by every thread*/
+		static unsigned long long getTotal();
+		/* Allocations since the start of the calling thread, e.g. the render thread around a frame*/
+		static unsigned long long getThreadTotal();
+
+		/* Totals of a tag since the start of the process*/
+		static AllocationStats getStats(AllocationTag tag);
+		/* Most bytes that were live at once, over all tags*/
+		static long long getPeakLiveBytes();
+		static const char* getTagName(AllocationTag tag);
+
+		/* Closes a frame, the counts of every tag since the last call go to the profiler counters*/
+		static void EndFrame();
+		/* Allocations and bytes of a tag in the last frame closed by EndFrame*/
+		static AllocationStats getLastFrame(AllocationTag tag);
+	};
+
+	/* Charges the allocations of the calling thread to tag while it lives, scopes nest*/
+	class AllocationScope
+	{
+	public:
+		explicit AllocationScope(AllocationTag tag);
+		~AllocationScope();
+
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+	private:
+		AllocationTag m_previous;
+	};
+}
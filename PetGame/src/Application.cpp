@@ -4,42 +4,176 @@
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "Profiler.h"
+#include "AllocationCounter.h"
+#include "GLState.h"
+#include "ShaderCache.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 
 
 namespace PetGame {
 	static void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+	static void window_refresh_callback(GLFWwindow* window);
+	static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void char_callback(GLFWwindow* window, unsigned int codepoint);
+	static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+	static void cursor_pos_callback(GLFWwindow* window, double x, double y);
+	static void scroll_callback(GLFWwindow* window, double x, double y);
+
+	static ProfilerCounter s_framesRendered("Frame/Rendered");
+	static ProfilerCounter s_framesSkipped("Frame/Skipped");
+	static ProfilerCounter s_frameAllocations("Memory/Heap allocations per frame", ProfilerCounter::Kind::Gauge);
+
+	// Frames that may allocate while caches and buffers grow, before the allocation budget applies.
+	// Drivers also compile shader variants on first use, e.g. llvmpipe allocates a few frames in
+	static const int ALLOCATION_WARMUP_FRAMES = 10;
+
+	static void* ImGuiAllocate(size_t size, void* userData) { return ::operator new(size); }
+	static void ImGuiFree(void* memory, void* userData) { ::operator delete(memory); }
+
+	// ImGui needs a few frames after an input event to settle hover and active states
+	static const int INPUT_DIRTY_FRAMES = 3;
+
+	// Fraction of the view added on every side of the rect the simulation publishes
+	static const float VIEW_MARGIN = 0.5f;
+	// Distance between the pets spawned by setPetCount, in world units
+	static const float PET_SPACING = 192.f;
+	static const float CAMERA_PAN_SPEED = 600.f;
+	static const float CAMERA_ZOOM_STEP = 1.1f;
+	static const float CAMERA_FOLLOW_SPEED = 6.f;
 
 	Application::Application()
 		: m_window(nullptr),
 		m_windowWidth(0),
 		m_windowHeight(0),
-		m_tickCount(0),
+		m_sceneWidth(0),
+		m_sceneHeight(0),
+		m_virtualWidth(0),
+		m_virtualHeight(0),
 		m_currentTime(0),
 		m_deltaTime(0),
 		m_fixedTickDuration(1.f / 2.f),
-		m_timeAccumulator(0),
-		m_shaderProgram(nullptr),
-		m_pet(nullptr),
-		m_renderer(nullptr)
+		m_shaders(nullptr),
+		m_renderer(nullptr),
+		m_simulation(nullptr),
+		m_frameUniforms(nullptr),
+		m_textures(nullptr),
+		m_hotReload(nullptr),
+		m_renderTarget(nullptr),
+		m_headlessContext(nullptr)
 	{
 	}
 
 	Application::~Application()
 	{
-		delete m_shaderProgram;
+		delete m_simulation;
 	}
 
 	bool Application::Init(const int width, const int height, const char* windowTitle)
 	{
 		m_windowWidth = width;
 		m_windowHeight = height;
+		m_sceneWidth = width;
+		m_sceneHeight = height;
 
+		// Headless runs still use GLFW for the timer and empty events, the null platform needs no display
+		if (m_headless) {
+			glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+		}
 		if (!glfwInit()) {
 			std::cout << "GLFW Was not initialized" << std::endl;
 			return false;
 		}
 
+		GLADloadproc loader = m_headless ? (GLADloadproc)HeadlessContext::GetProcAddress : (GLADloadproc)glfwGetProcAddress;
+		if (m_headless ? !InitHeadless() : !InitWindow(windowTitle)) {
+			Stop();
+			return false;
+		}
+
+		// Loading GLAD
+		if (!gladLoadGLLoader(loader))
+		{
+			std::cout << "Failed load GLAD" << std::endl;
+			Stop();
+			return false;
+		}
+
+		if (!m_headless) {
+			m_framePacer.Apply();
+		}
+		ShaderCache::Init(loader);
+		Texture2D::Init(loader);
+
+		m_shaders = new ShaderRegistry();
+		m_spriteShader = m_shaders->Load("sprite", "shaders/sprite.vert", "shaders/sprite.frag");
+		m_pointShader = m_shaders->Load("point", "shaders/point.vert", "shaders/point.frag");
+		m_renderer = new SpriteRenderer(*m_shaders, m_spriteShader, m_pointShader);
+		m_frameUniforms = new FrameUniforms();
+		m_textures = new TextureCache();
+
+		// Without a window the target is the only framebuffer there is
+		if (m_headless && (m_virtualWidth <= 0 || m_virtualHeight <= 0)) {
+			m_virtualWidth = m_sceneWidth;
+			m_virtualHeight = m_sceneHeight;
+		}
+		if (m_virtualWidth > 0 && m_virtualHeight > 0) {
+			m_renderTarget = new RenderTarget(m_virtualWidth, m_virtualHeight);
+			if (!m_renderTarget->isComplete()) {
+				delete m_renderTarget;
+				m_renderTarget = nullptr;
+			}
+		}
+		if (m_headless && !m_renderTarget) {
+			Stop();
+			return false;
+		}
+
+		// Creating ViewPort
+		glViewport(0, 0, m_windowWidth, m_windowHeight);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		m_currentTime = (float)glfwGetTime();
+
+		// Pet textures are created here, on the thread that owns the GL context
+		AllocationScope allocationScope(AllocationTag::Sim);
+		m_simulation = new Simulation(m_fixedTickDuration);
+		m_simulation->setTickBudget(5, 2.f, true);
+		glm::vec2 center = glm::vec2((float)m_sceneWidth, (float)m_sceneHeight) * 0.5f;
+		PetWorld& world = m_simulation->getWorld();
+		m_selectedPet = world.Create(std::make_unique<DigiPet::Pet>("Titanzada", *m_textures, center));
+		m_simulation->PushCommand(PetCommand::Select, m_selectedPet);
+
+		int columns = (int)std::ceil(std::sqrt((double)m_petCount));
+		int half = columns / 2;
+		for (int cell = 0, created = 1; created < m_petCount; cell++) {
+			glm::vec2 offset((float)(cell % columns - half), (float)(cell / columns - half));
+			// The center is taken by the first pet
+			if (offset == glm::vec2(0.f)) {
+				continue;
+			}
+			world.Create(std::make_unique<DigiPet::Pet>("Pet " + std::to_string(created), *m_textures, center + offset * PET_SPACING));
+			created++;
+		}
+
+		m_camera.setViewportSize(glm::vec2((float)m_sceneWidth, (float)m_sceneHeight));
+		m_camera.setPosition(center);
+		m_lastCameraTime = glfwGetTime();
+		UpdateViewRect();
 
+		if (m_hotReloadEnabled && !m_headless) {
+			m_hotReload = new HotReload(*m_shaders, *m_textures);
+			m_hotReload->Start();
+		}
+
+		return true;
+	}
+
+	bool Application::InitWindow(const char* windowTitle)
+	{
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -48,6 +182,8 @@ namespace PetGame {
 		glfwSetWindowUserPointer(m_window, this);
 
 		IMGUI_CHECKVERSION();
+		// Through operator new, so ImGui shows up in the allocation counts
+		ImGui::SetAllocatorFunctions(ImGuiAllocate, ImGuiFree);
 		ImGui::CreateContext();
 		ImGuiIO& io = ImGui::GetIO();
 		io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -56,7 +192,6 @@ namespace PetGame {
 
 		if (m_window == NULL) {
 			std::cout << "Failed to create window" << std::endl;
-			Stop();
 			return false;
 		}
 
@@ -64,76 +199,124 @@ namespace PetGame {
 		// Conecting GLFW current context
 		glfwMakeContextCurrent(m_window);
 
+		// Input callbacks only mark the frame dirty, they are registered before ImGui so it chains to them
+		glfwSetWindowRefreshCallback(m_window, window_refresh_callback);
+		glfwSetKeyCallback(m_window, key_callback);
+		glfwSetCharCallback(m_window, char_callback);
+		glfwSetMouseButtonCallback(m_window, mouse_button_callback);
+		glfwSetCursorPosCallback(m_window, cursor_pos_callback);
+		glfwSetScrollCallback(m_window, scroll_callback);
+
 		ImGui_ImplGlfw_InitForOpenGL(m_window, true);          // Second param install_callback=true will install GLFW callbacks and chain to existing ones.
 		ImGui_ImplOpenGL3_Init();
 
 		// RegisterCallBack
 		glfwSetFramebufferSizeCallback(m_window, framebuffer_size_callback);
-
-		// Loading GLAD
-		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-		{
-			std::cout << "Failed load GLAD" << std::endl;
-			Stop();
-			return false;
-		}
-
-		m_shaderProgram = new Shader("shaders/sprite.vert", "shaders/sprite.frag");
-		m_renderer = new SpriteRenderer(*m_shaderProgram);
-
-		// Creating ViewPort
-		glViewport(0, 0, m_windowWidth, m_windowHeight);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		m_currentTime = (float)glfwGetTime();
-
-		m_pet = new DigiPet::Pet("Titanzada");
-
 		return true;
 	}
 
+	bool Application::InitHeadless()
+	{
+#ifdef PETGAME_HEADLESS
+		m_headlessContext = new HeadlessContext();
+		return m_headlessContext->Create();
+#else
+		std::cout << "Built without headless support, reconfigure with PETGAME_HEADLESS" << std::endl;
+		return false;
+#endif
+	}
+
 	void Application::Start()
 	{
-		m_shaderProgram->use();
-		glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(m_windowWidth),
-			0.0f, static_cast<float>(m_windowHeight),
-			-1.0f, 1.0f);
-		m_shaderProgram->setMat4("projection", projection);
-		m_shaderProgram->setInt("spriteTexture", 0);
+		if (m_headless) {
+			RunHeadless();
+			return;
+		}
+
+		m_simulation->setWakeOnPublish(m_renderOnDemand);
+		m_simulation->Start();
 
 		while (!glfwWindowShouldClose(m_window)) {
 
-			float currentFrameTime = (float)glfwGetTime();
+			WaitForEvents();
+			if (m_simulation->getSnapshots().Acquire()) {
+				m_selectedPet = m_simulation->getSnapshots().Front().selectedPet;
+				MarkDirty();
+			}
+
+			PetGame::Application::ProcessInputs();
+			if (UpdateCamera()) {
+				UpdateViewRect();
+				MarkDirty();
+			}
+			if (m_hotReload && m_hotReload->Apply()) {
+				// Low detail copies are made from the old pixels, let them be rebuilt
+				m_renderer->getLodAtlas().Clear();
+				MarkDirty();
+			}
+
+			double now = glfwGetTime();
+			if (!NeedsRender(now)) {
+				s_framesSkipped.Add();
+				continue;
+			}
+
+			float currentFrameTime = (float)now;
 			float deltaTime = currentFrameTime - m_currentTime;
 			m_currentTime = currentFrameTime;
 			m_deltaTime = deltaTime;
-			if (deltaTime > 0.03)
+			// Gaps between on demand frames are idle time, not lag
+			if (deltaTime > 0.03 && !m_renderOnDemand)
 			{
 				std::cout << "LagSpike!!! FrameTime:" << deltaTime;
 				std::cout << " | FPS:" << 1.f / deltaTime << std::endl;
 			}
 
-			m_timeAccumulator += deltaTime;
-			while (m_timeAccumulator >= m_fixedTickDuration) {
-				FixedUpdate();
-				m_timeAccumulator -= m_fixedTickDuration;
-			}
-
-			glfwPollEvents();
-
+			m_framePacer.BeginFrame();
 			PetGame::Application::RenderUi();
-
-			PetGame::Application::ProcessInputs();
 			PetGame::Application::Render();
+			m_framePacer.EndFrame();
+
+			m_lastRenderTime = now;
+			if (m_dirtyFrames > 0) {
+				m_dirtyFrames--;
+			}
+			s_framesRendered.Add();
 		}
+
+		m_simulation->Stop();
 	}
 
 	void Application::Stop()
 	{
-		ImGui_ImplOpenGL3_Shutdown();
-		ImGui_ImplGlfw_Shutdown();
-		ImGui::DestroyContext();
+		if (m_simulation) {
+			m_simulation->Stop();
+		}
+
+		delete m_hotReload;
+		m_hotReload = nullptr;
+
+		// GL objects have to go while the context is still alive
+		delete m_renderTarget;
+		m_renderTarget = nullptr;
+		delete m_renderer;
+		m_renderer = nullptr;
+		delete m_frameUniforms;
+		m_frameUniforms = nullptr;
+		delete m_shaders;
+		m_shaders = nullptr;
+		delete m_textures;
+		m_textures = nullptr;
+
+		if (m_window) {
+			ImGui_ImplOpenGL3_Shutdown();
+			ImGui_ImplGlfw_Shutdown();
+			ImGui::DestroyContext();
+		}
+#ifdef PETGAME_HEADLESS
+		delete m_headlessContext;
+		m_headlessContext = nullptr;
+#endif
 
 		glfwTerminate();
 
@@ -146,12 +329,208 @@ namespace PetGame {
 	{
 		m_windowWidth = width;
 		m_windowHeight = height;
+		// The render target keeps the scene size, without it the window shows more or less of the world
+		if (!m_renderTarget) {
+			m_camera.setViewportSize(glm::vec2((float)width, (float)height));
+		}
+		m_hasViewRect = false;
+		UpdateViewRect();
+	}
 
-		m_shaderProgram->use();
-		glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(m_windowWidth),
-			0.0f, static_cast<float>(m_windowHeight),
-			-1.0f, 1.0f);
-		m_shaderProgram->setMat4("projection", projection);
+	void Application::UpdateViewRect()
+	{
+		if (!m_simulation) {
+			return;
+		}
+		glm::vec2 min, max;
+		m_camera.getVisibleRect(min, max);
+		glm::vec2 extent = max - min;
+
+		// Small pans stay inside the margin and need no new snapshot, zooming in far enough shrinks the rect again
+		bool inside = m_hasViewRect
+			&& min.x >= m_viewRectMin.x && min.y >= m_viewRectMin.y
+			&& max.x <= m_viewRectMax.x && max.y <= m_viewRectMax.y;
+		bool oversized = (m_viewRectMax.x - m_viewRectMin.x) > extent.x * (2.f + 4.f * VIEW_MARGIN);
+		if (inside && !oversized) {
+			return;
+		}
+		m_viewRectMin = min - extent * VIEW_MARGIN;
+		m_viewRectMax = max + extent * VIEW_MARGIN;
+		m_hasViewRect = true;
+		m_simulation->setViewRect(m_viewRectMin, m_viewRectMax);
+	}
+
+	bool Application::UpdateCamera()
+	{
+		double now = glfwGetTime();
+		float deltaTime = glm::min((float)(now - m_lastCameraTime), 0.1f);
+		m_lastCameraTime = now;
+
+		glm::vec2 before = m_camera.getPosition();
+		float zoomBefore = m_camera.getZoom();
+		bool mouseFree = !ImGui::GetIO().WantCaptureMouse;
+
+		// Arrows pan at a constant speed on screen, so slower in world units when zoomed in
+		glm::vec2 direction(0.f);
+		direction.x += (glfwGetKey(m_window, GLFW_KEY_RIGHT) == GLFW_PRESS) ? 1.f : 0.f;
+		direction.x -= (glfwGetKey(m_window, GLFW_KEY_LEFT) == GLFW_PRESS) ? 1.f : 0.f;
+		direction.y += (glfwGetKey(m_window, GLFW_KEY_UP) == GLFW_PRESS) ? 1.f : 0.f;
+		direction.y -= (glfwGetKey(m_window, GLFW_KEY_DOWN) == GLFW_PRESS) ? 1.f : 0.f;
+		if (direction != glm::vec2(0.f) && !ImGui::GetIO().WantCaptureKeyboard) {
+			m_camera.Pan(direction * (CAMERA_PAN_SPEED * deltaTime / m_camera.getZoom()));
+			m_followSelected = false;
+		}
+
+		double cursorX, cursorY;
+		glfwGetCursorPos(m_window, &cursorX, &cursorY);
+		glm::vec2 cursor = ScreenToScene(cursorX, cursorY);
+
+		// Right drag keeps the world point under the cursor
+		bool rightMouseDown = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+		if (rightMouseDown && (m_dragging || mouseFree)) {
+			if (m_dragging) {
+				m_camera.Pan(m_camera.SceneToWorld(m_dragScenePosition) - m_camera.SceneToWorld(cursor));
+				m_followSelected = false;
+			}
+			m_dragging = true;
+			m_dragScenePosition = cursor;
+		}
+		else {
+			m_dragging = false;
+		}
+
+		if (m_scrollDelta != 0.f && mouseFree) {
+			m_camera.Zoom(std::pow(CAMERA_ZOOM_STEP, m_scrollDelta), cursor);
+		}
+		m_scrollDelta = 0.f;
+
+		if (m_followSelected) {
+			const PetStatus* status = m_simulation->getSnapshots().Front().FindStatus(m_selectedPet);
+			if (status) {
+				m_camera.MoveTowards(status->position, CAMERA_FOLLOW_SPEED, deltaTime);
+			}
+		}
+
+		return m_camera.getPosition() != before || m_camera.getZoom() != zoomBefore;
+	}
+
+	glm::vec2 Application::ScreenToScene(double x, double y) const
+	{
+		// GLFW counts from the top left, the scene from the bottom left
+		glm::vec2 screen((float)x, (float)(m_windowHeight - y));
+		if (!m_renderTarget) {
+			return screen;
+		}
+		int rectX, rectY, rectWidth, rectHeight;
+		m_renderTarget->getBlitRect(m_windowWidth, m_windowHeight, rectX, rectY, rectWidth, rectHeight);
+		glm::vec2 local = (screen - glm::vec2((float)rectX, (float)rectY)) / glm::vec2((float)rectWidth, (float)rectHeight);
+		return local * glm::vec2((float)m_sceneWidth, (float)m_sceneHeight);
+	}
+
+	void Application::setVirtualResolution(int width, int height)
+	{
+		m_virtualWidth = width;
+		m_virtualHeight = height;
+	}
+
+	void Application::setHeadless(int frameCount, const std::string& captureDirectory)
+	{
+		m_headless = true;
+		m_headlessFrames = frameCount;
+		m_captureDirectory = captureDirectory;
+	}
+
+	void Application::RunHeadless()
+	{
+		if (!m_captureDirectory.empty()) {
+			std::error_code error;
+			std::filesystem::create_directories(m_captureDirectory, error);
+		}
+
+		m_simulation->Start();
+
+		double start = glfwGetTime();
+		for (int frame = 0; frame < m_headlessFrames; frame++) {
+			m_simulation->getSnapshots().Acquire();
+
+			float currentFrameTime = (float)glfwGetTime();
+			m_deltaTime = currentFrameTime - m_currentTime;
+			m_currentTime = currentFrameTime;
+
+			RenderScene();
+			EndFrame();
+
+			if (m_frameAllocationBudget >= 0 && frame >= ALLOCATION_WARMUP_FRAMES && m_frameAllocations > (unsigned long long)m_frameAllocationBudget) {
+				std::cout << "Frame " << frame << " made " << m_frameAllocations << " heap allocations, the budget is " << m_frameAllocationBudget << std::endl;
+				PrintFrameAllocations();
+				m_allocationBudgetExceeded = true;
+			}
+
+			if (!m_captureDirectory.empty()) {
+				char fileName[32];
+				std::snprintf(fileName, sizeof(fileName), "/frame_%04d.png", frame);
+				m_renderTarget->Capture(m_captureDirectory + fileName);
+			}
+		}
+		glFinish();
+		double elapsed = glfwGetTime() - start;
+
+		std::cout << "Rendered " << m_headlessFrames << " frames in " << elapsed * 1000.0 << " ms";
+		if (m_headlessFrames > 0) {
+			std::cout << " | " << elapsed * 1000.0 / m_headlessFrames << " ms per frame";
+		}
+		if (AllocationCounter::isEnabled()) {
+			std::cout << " | " << m_frameAllocations << " heap allocations in the last frame";
+		}
+		std::cout << std::endl;
+
+		if (AllocationCounter::isEnabled()) {
+			PrintFrameAllocations();
+		}
+
+		m_simulation->Stop();
+	}
+
+	void Application::setFramePacing(VSyncMode vsync, float targetFps)
+	{
+		m_framePacer.setVSync(vsync);
+		m_framePacer.setTargetFps(targetFps);
+	}
+
+	void Application::WaitForEvents()
+	{
+		if (!m_renderOnDemand || m_dirtyFrames > 0) {
+			glfwPollEvents();
+			return;
+		}
+
+		// Sleep until an input event, a new snapshot or the next animation frame
+		const RenderSnapshot& snapshot = m_simulation->getSnapshots().Front();
+		double now = glfwGetTime();
+		double timeout = snapshot.motionTickDuration;
+		if (snapshot.hasMotion() && snapshot.getAlpha(now) < 1.f) {
+			timeout = (m_lastRenderTime + m_animationFrameInterval) - now;
+		}
+		if (timeout > 0.0) {
+			glfwWaitEventsTimeout(timeout);
+		}
+		else {
+			glfwPollEvents();
+		}
+	}
+
+	bool Application::NeedsRender(double time)
+	{
+		if (!m_renderOnDemand || m_dirtyFrames > 0) {
+			return true;
+		}
+
+		// Keep drawing at the animation rate while sprites are still being interpolated
+		const RenderSnapshot& snapshot = m_simulation->getSnapshots().Front();
+		if (snapshot.getAlpha(m_lastRenderTime) < 1.f && snapshot.hasMotion()) {
+			return time - m_lastRenderTime >= m_animationFrameInterval;
+		}
+		return false;
 	}
 
 	void Application::ProcessInputs()
@@ -164,14 +543,14 @@ namespace PetGame {
 		// C Feed
 		static bool cKeyPressed = false;
 		if (glfwGetKey(m_window, GLFW_KEY_C) == GLFW_PRESS && !cKeyPressed) {
-			m_pet->feed(m_tickCount);
+			m_simulation->PushCommand(PetCommand::Feed, m_selectedPet);
 			cKeyPressed = true;
 		} if (glfwGetKey(m_window, GLFW_KEY_C) == GLFW_RELEASE) cKeyPressed = false;
 
 		// Z Train
 		static bool zKeyPressed = false;
 		if (glfwGetKey(m_window, GLFW_KEY_Z) == GLFW_PRESS && !zKeyPressed) {
-			m_pet->displayStatus();
+			m_simulation->PushCommand(PetCommand::DisplayStatus, m_selectedPet);
 			zKeyPressed = true;
 		} if (glfwGetKey(m_window, GLFW_KEY_Z) == GLFW_RELEASE) zKeyPressed = false;
 
@@ -182,39 +561,140 @@ namespace PetGame {
 			xKeyPressed = true;
 		} if (glfwGetKey(m_window, GLFW_KEY_X) == GLFW_RELEASE) xKeyPressed = false;
 
+		// Left click selects the pet under the cursor
+		static bool leftMousePressed = false;
+		bool leftMouseDown = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+		if (leftMouseDown && !leftMousePressed && !ImGui::GetIO().WantCaptureMouse) {
+			double cursorX, cursorY;
+			glfwGetCursorPos(m_window, &cursorX, &cursorY);
+			m_simulation->PushPick(m_camera.SceneToWorld(ScreenToScene(cursorX, cursorY)));
+		}
+		leftMousePressed = leftMouseDown;
+
+		// F Follow the selected pet
+		static bool fKeyPressed = false;
+		if (glfwGetKey(m_window, GLFW_KEY_F) == GLFW_PRESS && !fKeyPressed) {
+			m_followSelected = !m_followSelected;
+			fKeyPressed = true;
+		} if (glfwGetKey(m_window, GLFW_KEY_F) == GLFW_RELEASE) fKeyPressed = false;
+
+		// F1 Profiler
+		static bool f1KeyPressed = false;
+		if (glfwGetKey(m_window, GLFW_KEY_F1) == GLFW_PRESS && !f1KeyPressed) {
+			m_profilerOpen = !m_profilerOpen;
+			f1KeyPressed = true;
+		} if (glfwGetKey(m_window, GLFW_KEY_F1) == GLFW_RELEASE) f1KeyPressed = false;
+
 		static bool spacePressed = false;
 		if (glfwGetKey(m_window, GLFW_KEY_SPACE) == GLFW_PRESS && !spacePressed) {
-			m_pet->hurt(m_tickCount);
+			m_simulation->PushCommand(PetCommand::Hurt, m_selectedPet);
 			spacePressed = true;
 		} if (glfwGetKey(m_window, GLFW_KEY_X) == GLFW_RELEASE) spacePressed = false;
 	}
 
 	void Application::UpdateRender()
 	{
-		m_pet->UpdateRender(m_deltaTime);
-		m_renderer->DrawPet(m_pet);
+		const RenderSnapshot& snapshot = m_simulation->getSnapshots().Front();
+
+		float alpha = snapshot.getAlpha(glfwGetTime());
+		// The snapshot holds the margin around the view too, the renderer drops what is off screen
+		glm::vec2 visibleMin, visibleMax;
+		m_camera.getVisibleRect(visibleMin, visibleMax);
+		m_renderer->setCullRect(visibleMin, visibleMax);
+		m_renderer->Begin();
+		for (const SpriteInstance& sprite : snapshot.sprites) {
+			m_renderer->DrawSprite(sprite.Interpolated(alpha));
+		}
+		m_renderer->End();
 	}
 
-	void Application::FixedUpdate()
+	void Application::PrintFrameAllocations() const
 	{
-		m_pet->UpdateTick(m_fixedTickDuration, m_tickCount);
-		m_tickCount++;
+		std::cout << "Allocations in the last frame by tag:";
+		for (int tag = 0; tag < (int)AllocationTag::Count; tag++) {
+			AllocationStats frameStats = AllocationCounter::getLastFrame((AllocationTag)tag);
+			std::cout << " " << AllocationCounter::getTagName((AllocationTag)tag) << " " << frameStats.count << " (" << frameStats.bytes << " B)";
+		}
+		std::cout << " | peak live heap " << AllocationCounter::getPeakLiveBytes() << " B" << std::endl;
+	}
+
+	void Application::setFrameAllocationBudget(int allocations)
+	{
+		m_frameAllocationBudget = allocations;
+		if (allocations >= 0 && !AllocationCounter::isEnabled()) {
+			std::cout << "Allocation budget ignored, reconfigure with PETGAME_COUNT_ALLOCATIONS" << std::endl;
+		}
 	}
 
 	void Application::Render()
 	{
+		RenderScene();
+
+		if (m_renderTarget) {
+			// Clear for the letterbox bars, then one nearest neighbour blit, ImGui stays at window resolution
+			RenderTarget::BindDefault(m_windowWidth, m_windowHeight);
+			glClear(GL_COLOR_BUFFER_BIT);
+			m_renderTarget->BlitToScreen(m_windowWidth, m_windowHeight);
+		}
+
+		{
+			AllocationScope allocationScope(AllocationTag::UI);
+			ImGui::Render();
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
+		// ImGui restores the bindings it found, but it talks to GL directly so do not trust the cache
+		GLState::Invalidate();
+
+		glfwSwapBuffers(m_window);
+		EndFrame();
+	}
+
+	void Application::EndFrame()
+	{
+		m_frameArena.Reset();
+
+		unsigned long long allocations = AllocationCounter::getThreadTotal();
+		m_frameAllocations = allocations - m_frameAllocationMark;
+		m_frameAllocationMark = allocations;
+		s_frameAllocations.Set((long long)m_frameAllocations);
+		AllocationCounter::EndFrame();
+
+		Profiler::EndFrame();
+	}
+
+	void Application::RenderScene()
+	{
+		AllocationScope allocationScope(AllocationTag::Render);
 		glClearColor(.941f, .917f, .854f, 1.f);
+
+		int viewportWidth = m_renderTarget ? m_renderTarget->getWidth() : m_windowWidth;
+		int viewportHeight = m_renderTarget ? m_renderTarget->getHeight() : m_windowHeight;
+		if (m_renderTarget) {
+			m_renderTarget->Bind();
+		}
 		glClear(GL_COLOR_BUFFER_BIT);
-		UpdateRender();
 
-		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		// One upload per frame, shared by every program through the FrameData block
+		FrameData frameData;
+		// The projection covers the camera viewport, the camera itself only moves the view
+		glm::vec2 sceneSize = m_camera.getViewportSize();
+		frameData.projection = glm::ortho(0.0f, sceneSize.x,
+			0.0f, sceneSize.y,
+			-1.0f, 1.0f);
+		frameData.view = m_camera.getView();
+		frameData.time = glm::vec4((float)glfwGetTime(), m_deltaTime, 0.f, 0.f);
+		frameData.viewport = glm::vec4(0.f, 0.f, (float)viewportWidth, (float)viewportHeight);
+		m_frameUniforms->Update(frameData);
 
-		glfwSwapBuffers(m_window);
+		// LOD tiers go by actual pixels, which differ from scene units with a render target
+		m_renderer->setPixelsPerUnit(m_camera.getZoom() * (float)viewportWidth / sceneSize.x);
+
+		UpdateRender();
 	}
 
 	void Application::RenderUi()
 	{
+		AllocationScope allocationScope(AllocationTag::UI);
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
@@ -237,9 +717,15 @@ namespace PetGame {
 				// Status
 				ImGui::BeginGroup();
 				{
-					ImGui::Text("Name: %s", m_pet->getName().c_str());
-					ImGui::Text("Level: %s", m_pet->getLevel().c_str());
-					ImGui::Text("Hunger: %d/100", m_pet->getHunger());
+					const PetStatus* status = m_simulation->getSnapshots().Front().FindStatus(m_selectedPet);
+					if (status) {
+						ImGui::Text("Name: %.*s", (int)status->name.size(), status->name.data());
+						ImGui::Text("Level: %.*s", (int)status->level.size(), status->level.data());
+						ImGui::Text("Hunger: %d/100", status->hunger);
+					}
+					else {
+						ImGui::Text("No pet selected");
+					}
 				}
 				ImGui::EndGroup();
 
@@ -248,7 +734,7 @@ namespace PetGame {
 				{
 					ImVec2 size = ImGui::GetItemRectSize();
 					if (ImGui::Button("Feed", ImVec2((size.x - ImGui::GetStyle().ItemSpacing.x) * 0.5f, size.y / 2))) {
-						m_pet->feed(m_tickCount);
+						m_simulation->PushCommand(PetCommand::Feed, m_selectedPet);
 					}
 					
 					ImGui::Button("Train", ImVec2((size.x - ImGui::GetStyle().ItemSpacing.x) * 0.5f, size.y /2));
@@ -263,17 +749,57 @@ namespace PetGame {
 			ImGui::PopStyleColor();
 		}
 
+		if (m_profilerOpen) {
+			Profiler::DrawOverlay(&m_profilerOpen);
+		}
+
 		ImGui::ShowDemoWindow();
 	}
 
+	static void MarkWindowDirty(GLFWwindow* window, int frames) {
+		Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+		if (app) {
+			app->MarkDirty(frames);
+		}
+	}
+
+	static void window_refresh_callback(GLFWwindow* window) {
+		MarkWindowDirty(window, 1);
+	}
+
+	static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+		MarkWindowDirty(window, INPUT_DIRTY_FRAMES);
+	}
+
+	static void char_callback(GLFWwindow* window, unsigned int codepoint) {
+		MarkWindowDirty(window, INPUT_DIRTY_FRAMES);
+	}
+
+	static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+		MarkWindowDirty(window, INPUT_DIRTY_FRAMES);
+	}
+
+	static void cursor_pos_callback(GLFWwindow* window, double x, double y) {
+		MarkWindowDirty(window, INPUT_DIRTY_FRAMES);
+	}
+
+	static void scroll_callback(GLFWwindow* window, double x, double y) {
+		Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+		if (app) {
+			app->AddScroll(y);
+		}
+		MarkWindowDirty(window, INPUT_DIRTY_FRAMES);
+	}
+
 	static void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 		glViewport(0, 0, width, height);
 		Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
 		if (app) {
-			app->setWindowSize(width, height); // Cria um novo mtodo para a lgica
+			app->setWindowSize(width, height);
+			app->MarkDirty(); // Cria um novo mtodo para a lgica
+			// GLFW copies the title, the arena copy only has to last until the call returns
+			glfwSetWindowTitle(window, app->getFrameArena().Format("Tamagochi:: %d x %d", width, height));
 		}
-		std::string newTitle = "Tamagochi:: " + std::to_string(width) + " x " + std::to_string(height);
-		glfwSetWindowTitle(window, newTitle.c_str());
 	}
 
 }
\ No newline at end of file
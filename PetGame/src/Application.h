@@ -2,8 +2,18 @@
 #include <glad/glad.h> // Para carregar as funes do OpenGL
 #include <GLFW/glfw3.h> // Para gerenciamento de janela e entrada
 #include "DigiPet.h"
-#include "Shader.h"
+#include "ShaderRegistry.h"
 #include "SpriteRenderer.h"
+#include "Simulation.h"
+#include "RenderSnapshot.h"
+#include "FramePacer.h"
+#include "FrameUniforms.h"
+#include "TextureCache.h"
+#include "HotReload.h"
+#include "RenderTarget.h"
+#include "HeadlessContext.h"
+#include "Camera2D.h"
+#include "FrameArena.h"
 
 namespace PetGame {
 	class Application
@@ -20,29 +30,118 @@ namespace PetGame {
 
 		void setWindowSize(int width, int height);
 
+		/* When enabled frames are only drawn when something changed, the loop sleeps otherwise*/
+		void setRenderOnDemand(bool enabled) { m_renderOnDemand = enabled; };
+		/* Can be called before Init, the vsync mode is applied once the context exists*/
+		void setFramePacing(VSyncMode vsync, float targetFps);
+		/*
+			Renders the scene into a width x height offscreen target and scales it to the window by a
+			whole number. The scene keeps the coordinates of the size given to Init, only the pixel count
+			changes, so fragment cost no longer grows with the window. Zero disables it. Call before Init
+		*/
+		void setVirtualResolution(int width, int height);
+		/*
+			Renders frameCount frames without a window into an offscreen target, through the same scene
+			code as the window, and writes each one as a PNG when captureDirectory is set. Needs a build
+			with EGL (PETGAME_HEADLESS). Call before Init
+		*/
+		void setHeadless(int frameCount, const std::string& captureDirectory = "");
+		/* Watch shaders and assets and reload them while running, must be called before Init*/
+		void setHotReload(bool enabled) { m_hotReloadEnabled = enabled; };
+		/* Pets spawned at Init, the first one at the scene center and the rest on a lattice around it*/
+		void setPetCount(int count) { m_petCount = (count < 1) ? 1 : count; };
+		/* Initial camera zoom, below 1 shows more of the world*/
+		void setCameraZoom(float zoom) { m_camera.setZoom(zoom); };
+		/* Scroll wheel offset, consumed by the camera zoom on the next frame*/
+		void AddScroll(double offset) { m_scrollDelta += (float)offset; };
+		void MarkDirty(int frames = 1) { m_dirtyFrames = (frames > m_dirtyFrames) ? frames : m_dirtyFrames; };
+		/*
+			Most heap allocations a headless frame may make on the render thread once warmed up,
+			negative for no limit. Needs a build with PETGAME_COUNT_ALLOCATIONS
+		*/
+		void setFrameAllocationBudget(int allocations);
+		bool isAllocationBudgetExceeded() const { return m_allocationBudgetExceeded; };
+		/* Scratch memory of the render thread, reset after every frame*/
+		FrameArena& getFrameArena() { return m_frameArena; };
+
 	private:
 		GLFWwindow* m_window;
 
 		int m_windowWidth;
 		int m_windowHeight;
+		/* Size the scene is laid out in, the window size given to Init*/
+		int m_sceneWidth;
+		int m_sceneHeight;
+		int m_virtualWidth;
+		int m_virtualHeight;
 
-		int m_tickCount;
 		float m_currentTime;
 		float m_deltaTime;
 		float m_fixedTickDuration;
-		float m_timeAccumulator;
 
-		Shader* m_shaderProgram;
-		DigiPet::Pet* m_pet;
+		ShaderRegistry* m_shaders;
+		ShaderHandle m_spriteShader;
+		ShaderHandle m_pointShader;
 		SpriteRenderer* m_renderer;
+		Simulation* m_simulation;
+		/* Pet that input and the status window act on*/
+		PetHandle m_selectedPet;
+		FramePacer m_framePacer;
+		FrameUniforms* m_frameUniforms;
+		TextureCache* m_textures;
+		HotReload* m_hotReload;
+		RenderTarget* m_renderTarget;
+		HeadlessContext* m_headlessContext;
+		Camera2D m_camera;
+		/* World rect last sent to Simulation::setViewRect, the camera view plus a margin*/
+		bool m_hasViewRect = false;
+		glm::vec2 m_viewRectMin = glm::vec2(0.f);
+		glm::vec2 m_viewRectMax = glm::vec2(0.f);
+
+		bool m_renderOnDemand = true;
+		bool m_hotReloadEnabled = true;
+		bool m_headless = false;
+		int m_headlessFrames = 0;
+		int m_petCount = 1;
+		bool m_followSelected = false;
+		float m_scrollDelta = 0.f;
+		bool m_dragging = false;
+		glm::vec2 m_dragScenePosition = glm::vec2(0.f);
+		double m_lastCameraTime = 0.0;
+		std::string m_captureDirectory;
+		int m_dirtyFrames = 1;
+		double m_lastRenderTime = 0.0;
+		float m_animationFrameInterval = 1.f / 30.f;
 
 		bool m_guiOpen = false;
+		bool m_profilerOpen = false;
+
+		FrameArena m_frameArena;
+		/* Render thread allocation count at the end of the last frame, see AllocationCounter*/
+		unsigned long long m_frameAllocationMark = 0;
+		unsigned long long m_frameAllocations = 0;
+		int m_frameAllocationBudget = -1;
+		bool m_allocationBudgetExceeded = false;
 
+		bool InitWindow(const char* windowTitle);
+		bool InitHeadless();
+		void RunHeadless();
+		void WaitForEvents();
+		bool NeedsRender(double time);
 		void ProcessInputs();
+		/* Pan, zoom and follow input. Returns true when the camera moved*/
+		bool UpdateCamera();
+		/* Tells the simulation what part of the world the camera shows, when it left the last rect*/
+		void UpdateViewRect();
+		/* Window cursor position to scene coordinates*/
+		glm::vec2 ScreenToScene(double x, double y) const;
 		void UpdateRender();
-		void FixedUpdate();
 		void Render();
+		void RenderScene();
 		void RenderUi();
+		/* Closes the frame for the profiler and the frame arena, after the swap*/
+		void EndFrame();
+		void PrintFrameAllocations() const;
 
 	};
 }
@@ -0,0 +1,72 @@
+#include "Camera2D.h"
+#include <cmath>
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace PetGame {
+	Camera2D::Camera2D()
+		: m_position(0.f),
+		m_viewportSize(1.f),
+		m_zoom(1.f),
+		m_minZoom(0.05f),
+		m_maxZoom(8.f)
+	{
+	}
+
+	void Camera2D::setViewportSize(glm::vec2 size)
+	{
+		m_viewportSize = glm::max(size, glm::vec2(1.f));
+	}
+
+	void Camera2D::Zoom(float factor, glm::vec2 anchor)
+	{
+		glm::vec2 before = SceneToWorld(anchor);
+		setZoom(m_zoom * factor);
+		m_position += before - SceneToWorld(anchor);
+	}
+
+	void Camera2D::setZoom(float zoom)
+	{
+		m_zoom = glm::clamp(zoom, m_minZoom, m_maxZoom);
+	}
+
+	void Camera2D::setZoomLimits(float minZoom, float maxZoom)
+	{
+		m_minZoom = minZoom;
+		m_maxZoom = (maxZoom < minZoom) ? minZoom : maxZoom;
+		setZoom(m_zoom);
+	}
+
+	bool Camera2D::MoveTowards(glm::vec2 target, float speed, float deltaTime)
+	{
+		glm::vec2 offset = target - m_position;
+		// Below a tenth of a screen pixel the camera snaps, otherwise easing would keep it moving forever
+		if (glm::dot(offset, offset) * m_zoom * m_zoom < 0.01f) {
+			m_position = target;
+			return offset != glm::vec2(0.f);
+		}
+		// Frame rate independent exponential easing
+		float amount = 1.f - std::exp(-speed * deltaTime);
+		m_position += offset * amount;
+		return true;
+	}
+
+	glm::mat4 Camera2D::getView() const
+	{
+		glm::mat4 view = glm::translate(glm::mat4(1.f), glm::vec3(m_viewportSize * 0.5f, 0.f));
+		view = glm::scale(view, glm::vec3(m_zoom, m_zoom, 1.f));
+		view = glm::translate(view, glm::vec3(-m_position, 0.f));
+		return view;
+	}
+
+	void Camera2D::getVisibleRect(glm::vec2& min, glm::vec2& max) const
+	{
+		glm::vec2 halfExtent = m_viewportSize * 0.5f / m_zoom;
+		min = m_position - halfExtent;
+		max = m_position + halfExtent;
+	}
+
+	glm::vec2 Camera2D::SceneToWorld(glm::vec2 scenePoint) const
+	{
+		return m_position + (scenePoint - m_viewportSize * 0.5f) / m_zoom;
+	}
+}
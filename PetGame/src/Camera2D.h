@@ -0,0 +1,43 @@
+#pragma once
+#include "glm/glm.hpp"
+
+namespace PetGame {
+	/*
+		2D camera over the scene. The projection stays a fixed ortho over the viewport size, the
+		camera only produces the view matrix, so world units are scene pixels at zoom 1.
+		position is the world point shown at the center of the viewport.
+	*/
+	class Camera2D
+	{
+	public:
+		Camera2D();
+
+		/* Size the projection covers, in scene units*/
+		void setViewportSize(glm::vec2 size);
+		void setPosition(glm::vec2 position) { m_position = position; };
+		/* Moves by offset in world units*/
+		void Pan(glm::vec2 offset) { m_position += offset; };
+		/* Multiplies the zoom, the world point under anchor (scene coordinates) stays where it is*/
+		void Zoom(float factor, glm::vec2 anchor);
+		void setZoom(float zoom);
+		void setZoomLimits(float minZoom, float maxZoom);
+		/* Eases towards target, a higher speed follows tighter. Returns true when it moved*/
+		bool MoveTowards(glm::vec2 target, float speed, float deltaTime);
+
+		glm::vec2 getPosition() const { return m_position; };
+		float getZoom() const { return m_zoom; };
+		glm::vec2 getViewportSize() const { return m_viewportSize; };
+		glm::mat4 getView() const;
+		/* World rectangle the viewport shows*/
+		void getVisibleRect(glm::vec2& min, glm::vec2& max) const;
+		/* Scene coordinates (projection space, origin bottom left) to world coordinates*/
+		glm::vec2 SceneToWorld(glm::vec2 scenePoint) const;
+
+	private:
+		glm::vec2 m_position;
+		glm::vec2 m_viewportSize;
+		float m_zoom;
+		float m_minZoom;
+		float m_maxZoom;
+	};
+}
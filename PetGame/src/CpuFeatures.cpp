@@ -0,0 +1,96 @@
+#include "CpuFeatures.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(PETGAME_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace PetGame {
+#if defined(PETGAME_X86)
+	static void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4])
+	{
+#if defined(_MSC_VER)
+		__cpuidex((int*)registers, (int)leaf, (int)subleaf);
+#else
+		__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	static unsigned long long ReadXcr0()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int low, high;
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return ((unsigned long long)high << 32) | low;
+#endif
+	}
+#endif
+
+	static SimdLevel DetectSimdLevel()
+	{
+#if defined(PETGAME_X86)
+		unsigned int registers[4] = {};
+		Cpuid(0, 0, registers);
+		unsigned int maxLeaf = registers[0];
+
+		Cpuid(1, 0, registers);
+		bool sse41 = (registers[2] & (1u << 19)) != 0;
+		bool osxsave = (registers[2] & (1u << 27)) != 0;
+		bool avx = (registers[2] & (1u << 28)) != 0;
+		// The CPU having AVX is not enough, the OS also has to save the upper register halves
+		bool ymmEnabled = osxsave && avx && (ReadXcr0() & 0x6) == 0x6;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7) {
+			Cpuid(7, 0, registers);
+			avx2 = ymmEnabled && (registers[1] & (1u << 5)) != 0;
+		}
+
+		if (avx2) {
+			return SimdLevel::AVX2;
+		}
+		if (sse41) {
+			return SimdLevel::SSE41;
+		}
+#endif
+		return SimdLevel::Scalar;
+	}
+
+	SimdLevel getSimdLevel()
+	{
+		static const SimdLevel level = []() {
+			SimdLevel detected = DetectSimdLevel();
+			const char* requested = std::getenv("PETGAME_SIMD");
+			if (requested) {
+				SimdLevel cap = SimdLevel::AVX2;
+				if (std::strcmp(requested, "scalar") == 0) {
+					cap = SimdLevel::Scalar;
+				}
+				else if (std::strcmp(requested, "sse41") == 0) {
+					cap = SimdLevel::SSE41;
+				}
+				detected = (cap < detected) ? cap : detected;
+			}
+			std::cout << "SIMD kernels: " << getSimdLevelName(detected) << std::endl;
+			return detected;
+		}();
+		return level;
+	}
+
+	const char* getSimdLevelName(SimdLevel level)
+	{
+		switch (level) {
+		case SimdLevel::SSE41: return "SSE4.1";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "scalar";
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Lets a single function use an instruction set the rest of the build does not assume
+#if defined(__GNUC__) || defined(__clang__)
+#define PETGAME_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PETGAME_TARGET(isa)
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PETGAME_X86 1
+#endif
+
+namespace PetGame {
+	/* Vector instruction sets the SIMD kernels have paths for, in increasing order*/
+	enum class SimdLevel {
+		Scalar,
+		SSE41,
+		AVX2,
+	};
+
+	/*
+		Best level the CPU and the OS support, read once with CPUID. The PETGAME_SIMD environment
+		variable (scalar, sse41 or avx2) can lower it, e.g. to compare the kernels
+	*/
+	SimdLevel getSimdLevel();
+	const char* getSimdLevelName(SimdLevel level);
+}
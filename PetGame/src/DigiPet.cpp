@@ -1,31 +1,36 @@
 #include "DigiPet.h"
 #include "Shader.h"
+#include <algorithm>
 
 namespace PetGame {
 	namespace DigiPet {
-		struct CONFIG {
-			static const int MAX_HUNGER = 100;
-			static const int MIN_HUNGER = 0;
-		};
-		Pet::Pet(const std::string& name) :
-			m_name(name),
-			m_hunger(50),
-			m_experience(0),
+		Pet::Pet(std::string_view name, TextureCache& textures, glm::vec2 home) :
+			m_nameId(NameTable::Intern(name)),
+			m_name(NameTable::Get(m_nameId)),
+			m_vitals(nullptr),
+			m_vitalsRow(0),
+			m_detachedVitals(),
 			m_level(Level::Puppy),
 			m_currentState(nullptr),
+			m_home(home),
 			m_position(0.f, 0.f),
 			m_size(0.f, 0.f),
 			m_rotation(0.f),
-			m_colorTint(1.f, 1.f, 1.f)
+			m_colorTint(1.f, 1.f, 1.f),
+			m_animationTime(0.f),
+			m_previousPosition(0.f, 0.f),
+			m_previousRotation(0.f)
 		{
+			m_detachedVitals[(size_t)PetVital::Hunger] = 50;
+
 			//Initial State
 			ChangeState(new IdleState(), 0);
-			setTextures();
+			setTextures(textures);
 
 
 			m_size = glm::vec2(128.f);
-			static const glm::vec2 center = (glm::vec2(800.f, 600.f) / 2.f) - (m_size);
-			m_position = center;
+			m_position = m_home - m_size;
+			m_previousPosition = m_position;
 		}
 
 		Pet::~Pet()
@@ -48,11 +53,26 @@ namespace PetGame {
 			}
 		}
 
-		void Pet::UpdateRender(float deltaTime)
+		void Pet::AdvanceTicks(float deltaTime, int tickCount, int ticks)
 		{
-			static float time = 0.f;
-			static const glm::vec2 center = (glm::vec2(800.f, 600.f)) / 2.f;
-			time += deltaTime;
+			int tick = tickCount;
+			int endTick = tickCount + ticks;
+			while (tick < endTick) {
+				int consumed = m_currentState ? m_currentState->advance(this, deltaTime, tick, endTick - tick) : endTick - tick;
+				tick += (consumed > 0) ? consumed : 1;
+			}
+			if (m_IsHurting) {
+				this->hurting(endTick - 1);
+			}
+		}
+
+		void Pet::UpdateMotion(float deltaTime)
+		{
+			const glm::vec2 center = m_home;
+			m_previousPosition = m_position;
+			m_previousRotation = m_rotation;
+			m_animationTime += deltaTime;
+			const float time = m_animationTime;
 
 			switch (m_level) {
 			case (Level::Egg):
@@ -63,7 +83,7 @@ namespace PetGame {
 				m_position = glm::vec2(center.x, center.y + (glm::sin(time) * 2.f));
 				break;
 			default:
-				m_position = m_position + glm::vec2(glm::sin(time), glm::cos(time));
+				m_position = m_position + glm::vec2(glm::sin(time), glm::cos(time)) * (CONFIG::DRIFT_SPEED * deltaTime);
 			}
 
 			//m_position = center;
@@ -88,58 +108,97 @@ namespace PetGame {
 
 		void Pet::train(const int hours)
 		{
-			setXp(m_experience + hours);
-		}
-
-		std::string Pet::getLevel() const
-		{
-			switch (m_level) {
-			case(Level::Egg): return "Egg";
-			case(Level::Puppy): return "Puppy";
-			case(Level::Child): return "Child";
-			case(Level::Adult): return "Adult";
-			default: return "Unknown";
-			}
+			setXp(getXp() + hours);
 		}
 
 		Texture2D* Pet::getTexture() const
 		{
 			auto map = m_textures.find(m_level);
 			if (map != m_textures.end()) {
-				return map->second.get();
+				return map->second;
 			}
-			return m_textures.at(Level::Egg).get();
+			return m_textures.at(Level::Egg);
 		}
 
 
-		void Pet::setHunger(int value)
+		SpriteAnimation* Pet::getAnimation() const
 		{
+			auto map = m_animations.find(m_level);
+			if (map != m_animations.end()) {
+				return map->second;
+			}
+			return nullptr;
+		}
 
-			m_hunger = (value < CONFIG::MIN_HUNGER)
-				? CONFIG::MIN_HUNGER : (value > CONFIG::MAX_HUNGER)
-				? CONFIG::MAX_HUNGER : value;
+		void Pet::setHunger(int value)
+		{
+			setVital(PetVital::Hunger, std::clamp(value, CONFIG::MIN_HUNGER, CONFIG::MAX_HUNGER));
 		}
 
 		void Pet::setXp(int value)
 		{
-			m_experience = (value < 0) ? 0 : value;
+			setVital(PetVital::Experience, std::max(value, 0));
 			displayStatus();
 		}
 
-		void Pet::setTextures()
+		void Pet::setHungerRate(int perTick)
+		{
+			setVital(PetVital::HungerRate, perTick);
+		}
+
+		void Pet::setHungerDecay(int intervalTicks, int tick)
+		{
+			setVital(PetVital::HungerInterval, std::max(intervalTicks, 0));
+			setVital(PetVital::NextHungerTick, tick + intervalTicks);
+		}
+
+		void Pet::AttachVitals(PetVitals* vitals, uint32_t row)
+		{
+			m_vitals = vitals;
+			m_vitalsRow = row;
+		}
+
+		void Pet::DetachVitals()
+		{
+			m_detachedVitals = getVitalsRow();
+			m_vitals = nullptr;
+		}
+
+		PetVitalsRow Pet::getVitalsRow() const
+		{
+			return m_vitals ? m_vitals->getRow(m_vitalsRow) : m_detachedVitals;
+		}
+
+		int Pet::getVital(PetVital field) const
+		{
+			return m_vitals ? m_vitals->get(field, m_vitalsRow) : m_detachedVitals[(size_t)field];
+		}
+
+		void Pet::setVital(PetVital field, int value)
+		{
+			if (m_vitals) {
+				m_vitals->set(field, m_vitalsRow, value);
+			}
+			else {
+				m_detachedVitals[(size_t)field] = value;
+			}
+		}
+
+		void Pet::setTextures(TextureCache& textures)
 		{
-			m_textures[Level::Egg] = Texture2D::CreateTexture("assets/digitama.png");
-			m_textures[Level::Puppy] = Texture2D::CreateTexture("assets/baby1.png");
+			m_textures[Level::Egg] = textures.Load("assets/digitama.png");
+			m_textures[Level::Puppy] = textures.Load("assets/baby1.png");
+			m_animations[Level::Child] = textures.LoadAnimation("assets/doki.gif");
 		}
 
 		void Pet::displayStatus() const
 		{
 			std::cout << "___:::STATUS:::____ " << std::endl;
 			std::cout << "Pet: " << m_name << std::endl;
-			std::cout << "Hunger: " << m_hunger << std::endl;
-			std::cout << "XP: " << m_experience << std::endl;
+			std::cout << "Hunger: " << getHunger() << std::endl;
+			std::cout << "XP: " << getXp() << std::endl;
 			std::cout << "Level: " << getLevel() << std::endl;
-			std::cout << m_currentState->getCurrentActivity(const_cast<Pet*>(this)) << std::endl;
+			std::cout << m_name << " " << m_currentState->getCurrentActivity(this) << std::endl;
 		}
 		void Pet::hurt(int tick)
 		{
@@ -1,33 +1,52 @@
 #pragma once  
 
 #include <string>  
+#include <string_view>
 #include <iostream>
 #include "IState.h"
 #include "IdleState.h"
 #include "FeedingState.h"
 #include "Texture2D.h"
+#include "TextureCache.h"
 #include "glm/glm.hpp"
+#include "PetVitals.h"
+#include "NameTable.h"
 #include <map>
 #include <memory>
 
 namespace PetGame {
 	namespace DigiPet {
+		struct CONFIG {
+			static constexpr int MAX_HUNGER = 100;
+			static constexpr int MIN_HUNGER = 0;
+			// Drift speed of the default animation, in pixels per second
+			static constexpr float DRIFT_SPEED = 60.f;
+		};
 		enum Level {
 			Egg = 0,
 			Puppy = 1,
 			Child = 2,
 			Adult = 3,
 		};
+		constexpr std::string_view LEVEL_NAMES[] = { "Egg", "Puppy", "Child", "Adult" };
+		constexpr std::string_view getLevelName(Level level)
+		{
+			return (level >= Level::Egg && level <= Level::Adult) ? LEVEL_NAMES[level] : "Unknown";
+		}
+
 		class Pet
 		{
 		public:
-			Pet(const std::string& name);
+			/* home is the world point the pet idles around*/
+			/* The name is interned in the NameTable*/
+			Pet(std::string_view name, TextureCache& textures, glm::vec2 home);
 
 			~Pet();
 
 			/* Game Functions*/
 			void UpdateTick(float deltaTime, int tickCount);
-			void UpdateRender(float deltaTime);
+			void AdvanceTicks(float deltaTime, int tickCount, int ticks);
+			void UpdateMotion(float deltaTime);
 			void ChangeState(IState* newState, int tickCount);
 			
 			/* Actions*/
@@ -35,21 +54,40 @@ namespace PetGame {
 			void train(const int hours);
 
 			/* Getters*/
-			std::string getName() const { return m_name; };
-			int getHunger() const { return m_hunger; };
-			int getXp() const { return m_experience; };
-			std::string getLevel() const;
+			/* Views into the NameTable and the level names, valid for the whole run*/
+			std::string_view getName() const { return m_name; };
+			NameId getNameId() const { return m_nameId; };
+			int getHunger() const { return getVital(PetVital::Hunger); };
+			int getXp() const { return getVital(PetVital::Experience); };
+			std::string_view getLevel() const { return getLevelName(m_level); };
 			Texture2D* getTexture() const;
+			/* Animation of the current level, null when the level uses a still texture*/
+			SpriteAnimation* getAnimation() const;
+			glm::vec2 getHome() const { return m_home; };
 			glm::vec2 getPosition() const { return m_position; };
+			glm::vec2 getPreviousPosition() const { return m_previousPosition; };
 			glm::vec2 getSize() const  { return m_size; };
 			float getRotation() const { return m_rotation; };
+			float getPreviousRotation() const { return m_previousRotation; };
 			glm::vec3 getColorTint() const { return m_colorTint; };
 
 
 			/* Setters*/
 			void setHunger(int value);
 			void setXp(int value);
-			void setTextures();
+			void setTextures(TextureCache& textures);
+			/* Hunger added on every tick by PetVitals::Tick*/
+			void setHungerRate(int perTick);
+			/* One hunger point every intervalTicks ticks counted from tick, zero stops it*/
+			void setHungerDecay(int intervalTicks, int tick);
+
+			/*
+				Vitals live in the row of the world the pet belongs to, PetWorld attaches and detaches
+				the pet. A detached pet keeps its vitals in the pet itself
+			*/
+			void AttachVitals(PetVitals* vitals, uint32_t row);
+			void DetachVitals();
+			PetVitalsRow getVitalsRow() const;
 
 			/*Debug*/
 			void displayStatus() const;
@@ -59,20 +97,33 @@ namespace PetGame {
 			void hurting(int tick);
 
 		private:
-			std::string m_name;
-			int m_hunger;
-			int m_experience;
+			NameId m_nameId;
+			std::string_view m_name;
+			PetVitals* m_vitals;
+			uint32_t m_vitalsRow;
+			PetVitalsRow m_detachedVitals;
 			Level m_level;
 
+			glm::vec2 m_home;
 			glm::vec2 m_position;
 			glm::vec2 m_size;
 			float m_rotation;
 			glm::vec3 m_colorTint;
 
-			std::map<Level, std::unique_ptr<Texture2D>> m_textures;
+			/* Animation clock and the transform of the previous motion tick, used for interpolation*/
+			float m_animationTime;
+			glm::vec2 m_previousPosition;
+			float m_previousRotation;
+
+			/* Owned by the TextureCache*/
+			std::map<Level, Texture2D*> m_textures;
+			std::map<Level, SpriteAnimation*> m_animations;
 
 			IState* m_currentState;
 
+			int getVital(PetVital field) const;
+			void setVital(PetVital field, int value);
+
 			bool m_IsHurting = false;
 			int m_statedHurting = 0;
 		};
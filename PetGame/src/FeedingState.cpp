@@ -16,6 +16,7 @@ namespace PetGame {
 		{
 			std::cout << pet->getName() << " is Eating in tick:" << tick << std::endl;
 			m_startedFeedingTick = tick;
+			pet->setHungerRate(HUNGER_PER_EATING_TICK);
 		}
 
 		void FeedingState::update(Pet* pet, float deltaTime, int tick)
@@ -27,19 +28,18 @@ namespace PetGame {
 			}
 			else {
 				std::cout << pet->getName() << " Eat some" << std::endl;
-				int currentHunger = pet->getHunger();
-				pet->setHunger(currentHunger - 3);
 			}
 		}
 
 		void FeedingState::leave(Pet* pet, int tick = NULL)
 		{
 			std::cout << "Finished eating" << std::endl;
+			pet->setHungerRate(0);
 		}
 
-		std::string FeedingState::getCurrentActivity(const Pet* pet) const
+		std::string_view FeedingState::getCurrentActivity(const Pet* pet) const
 		{
-			return pet->getName() + " is busy eating.";
+			return "is busy eating.";
 		}
 	}
 
@@ -5,6 +5,7 @@
 namespace PetGame {
 	namespace DigiPet {
 		const int TICKS_TO_FINISH_EATING = 10;
+		const int HUNGER_PER_EATING_TICK = -3;
 		class FeedingState :
 			public IState
 		{
@@ -16,7 +17,7 @@ namespace PetGame {
 			void update(Pet* pet, float deltaTime, int tick) override;
 			void leave(Pet* pet, int tick) override;
 
-			std::string getCurrentActivity(const Pet* pet) const override;
+			std::string_view getCurrentActivity(const Pet* pet) const override;
 
 		private:
 			int m_startedFeedingTick;
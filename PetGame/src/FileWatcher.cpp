@@ -0,0 +1,139 @@
+#include "FileWatcher.h"
+#include <chrono>
+#include <iostream>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace PetGame {
+	// How long the thread blocks before checking whether it should stop
+	static const int WAKE_INTERVAL_MS = 100;
+#ifndef __linux__
+	static const int POLL_INTERVAL_MS = 250;
+#endif
+
+	FileWatcher::FileWatcher()
+		: m_running(false)
+#ifdef __linux__
+		, m_inotify(-1)
+#endif
+	{
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+	void FileWatcher::Watch(const std::string& directory)
+	{
+		m_directories.push_back(directory);
+	}
+
+	bool FileWatcher::Start(Callback callback)
+	{
+		if (m_running.load()) {
+			return true;
+		}
+		m_callback = std::move(callback);
+
+#ifdef __linux__
+		m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_inotify < 0) {
+			std::cout << "FileWatcher: inotify is not available" << std::endl;
+			return false;
+		}
+		// Editors either rewrite the file or write a temporary and rename it over the original
+		for (const std::string& directory : m_directories) {
+			int watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (watch < 0) {
+				std::cout << "FileWatcher: cannot watch " << directory << std::endl;
+				continue;
+			}
+			m_watches[watch] = directory;
+		}
+#else
+		Scan(false);
+#endif
+
+		m_running.store(true);
+		m_thread = std::thread(&FileWatcher::Run, this);
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		m_running.store(false);
+		if (m_thread.joinable()) {
+			m_thread.join();
+		}
+#ifdef __linux__
+		if (m_inotify >= 0) {
+			close(m_inotify);
+			m_inotify = -1;
+		}
+		m_watches.clear();
+#endif
+	}
+
+#ifdef __linux__
+	void FileWatcher::Run()
+	{
+		alignas(inotify_event) char buffer[4096];
+		pollfd descriptor = { m_inotify, POLLIN, 0 };
+
+		while (m_running.load()) {
+			if (poll(&descriptor, 1, WAKE_INTERVAL_MS) <= 0) {
+				continue;
+			}
+
+			ssize_t length;
+			while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0) {
+				for (char* cursor = buffer; cursor < buffer + length; ) {
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+					auto directory = m_watches.find(event->wd);
+					if (event->len > 0 && directory != m_watches.end()) {
+						m_callback(directory->second + "/" + event->name);
+					}
+					cursor += sizeof(inotify_event) + event->len;
+				}
+			}
+		}
+	}
+#else
+	void FileWatcher::Run()
+	{
+		int elapsed = 0;
+		while (m_running.load()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(WAKE_INTERVAL_MS));
+			elapsed += WAKE_INTERVAL_MS;
+			if (elapsed >= POLL_INTERVAL_MS) {
+				elapsed = 0;
+				Scan(true);
+			}
+		}
+	}
+
+	void FileWatcher::Scan(bool report)
+	{
+		std::error_code error;
+		for (const std::string& directory : m_directories) {
+			for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+				if (!entry.is_regular_file(error)) {
+					continue;
+				}
+				std::string filePath = directory + "/" + entry.path().filename().string();
+				std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+				auto known = m_writeTimes.find(filePath);
+				bool changed = known == m_writeTimes.end() || known->second != writeTime;
+				m_writeTimes[filePath] = writeTime;
+				if (changed && report) {
+					m_callback(filePath);
+				}
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef __linux__
+#include <filesystem>
+#endif
+
+namespace PetGame {
+	/*
+		Reports files written inside a set of directories from a background thread.
+		Uses inotify on Linux and polls modification times everywhere else.
+	*/
+	class FileWatcher
+	{
+	public:
+		/* Called on the watcher thread with directory/name of the file that changed*/
+		using Callback = std::function<void(const std::string& filePath)>;
+
+		FileWatcher();
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		/* Directories have to be added before Start*/
+		void Watch(const std::string& directory);
+		bool Start(Callback callback);
+		void Stop();
+
+	private:
+		std::vector<std::string> m_directories;
+		Callback m_callback;
+		std::thread m_thread;
+		std::atomic<bool> m_running;
+
+#ifdef __linux__
+		int m_inotify;
+		/* Watch descriptor to directory*/
+		std::map<int, std::string> m_watches;
+#else
+		std::map<std::string, std::filesystem::file_time_type> m_writeTimes;
+
+		void Scan(bool report);
+#endif
+
+		void Run();
+	};
+}
@@ -0,0 +1,89 @@
+#include "FrameArena.h"
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include "Profiler.h"
+
+namespace PetGame {
+	static ProfilerCounter s_arenaUsed("Memory/Frame arena used", ProfilerCounter::Kind::Gauge);
+	static ProfilerCounter s_arenaGrown("Memory/Frame arena grown");
+
+	FrameArena::FrameArena(size_t capacity)
+		: m_offset(0),
+		m_used(0),
+		m_peak(0),
+		m_resource(*this)
+	{
+		AddBlock((capacity > 0) ? capacity : 1);
+	}
+
+	void FrameArena::AddBlock(size_t size)
+	{
+		Block block;
+		block.memory.reset(new unsigned char[size]);
+		block.size = size;
+		m_blocks.push_back(std::move(block));
+		m_offset = 0;
+	}
+
+	void* FrameArena::Allocate(size_t bytes, size_t alignment)
+	{
+		Block* block = &m_blocks.back();
+		uintptr_t base = (uintptr_t)block->memory.get();
+		size_t start = (size_t)(((base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+		if (start + bytes > block->size) {
+			// Spill into a block at least as big as everything so far, Reset folds them together
+			size_t size = (bytes + alignment > getCapacity()) ? bytes + alignment : getCapacity();
+			AddBlock(size);
+			s_arenaGrown.Add();
+			block = &m_blocks.back();
+			base = (uintptr_t)block->memory.get();
+			start = (size_t)(((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+		}
+		m_offset = start + bytes;
+		m_used += bytes;
+		return block->memory.get() + start;
+	}
+
+	const char* FrameArena::Format(const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		va_list sizeArgs;
+		va_copy(sizeArgs, args);
+		int length = std::vsnprintf(nullptr, 0, format, sizeArgs);
+		va_end(sizeArgs);
+
+		char* text = AllocateArray<char>((length > 0) ? (size_t)length + 1 : 1);
+		if (length > 0) {
+			std::vsnprintf(text, (size_t)length + 1, format, args);
+		}
+		else {
+			text[0] = '\0';
+		}
+		va_end(args);
+		return text;
+	}
+
+	void FrameArena::Reset()
+	{
+		m_peak = (m_used > m_peak) ? m_used : m_peak;
+		s_arenaUsed.Set((long long)m_used);
+		if (m_blocks.size() > 1) {
+			size_t capacity = getCapacity();
+			m_blocks.clear();
+			AddBlock(capacity);
+		}
+		m_offset = 0;
+		m_used = 0;
+	}
+
+	size_t FrameArena::getCapacity() const
+	{
+		size_t capacity = 0;
+		for (const Block& block : m_blocks) {
+			capacity += block.size;
+		}
+		return capacity;
+	}
+}
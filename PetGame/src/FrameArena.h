@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace PetGame {
+	/*
+		Linear allocator for data that only lives for one frame. Allocating bumps an offset and Reset
+		frees everything at once, nothing is freed on its own. When a frame needs more than the arena
+		holds it spills into extra blocks, and the next Reset merges them into one block big enough
+		for that frame, so in steady state a frame makes no heap allocation at all.
+		Containers opt in through getResource, e.g. std::pmr::vector or std::pmr::string, and must not
+		outlive the next Reset. Not thread safe, meant for the render thread.
+	*/
+	class FrameArena
+	{
+	public:
+		explicit FrameArena(size_t capacity = 64 * 1024);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+		template<typename T>
+		T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); };
+		/* printf style string that is valid until the next Reset*/
+		const char* Format(const char* format, ...);
+
+		void Reset();
+
+		std::pmr::memory_resource* getResource() { return &m_resource; };
+
+		size_t getUsed() const { return m_used; };
+		size_t getCapacity() const;
+		/* Most bytes used by a single frame so far*/
+		size_t getPeak() const { return m_peak; };
+
+	private:
+		/* Hands the arena to std::pmr containers, freeing is left to Reset*/
+		class Resource : public std::pmr::memory_resource
+		{
+		public:
+			explicit Resource(FrameArena& arena) : m_arena(arena) {};
+
+		private:
+			FrameArena& m_arena;
+
+			void* do_allocate(size_t bytes, size_t alignment) override { return m_arena.Allocate(bytes, alignment); };
+			void do_deallocate(void* memory, size_t bytes, size_t alignment) override {};
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; };
+		};
+
+		struct Block {
+			std::unique_ptr<unsigned char[]> memory;
+			size_t size;
+		};
+
+		/* The last block is the one being filled*/
+		std::vector<Block> m_blocks;
+		size_t m_offset;
+		size_t m_used;
+		size_t m_peak;
+		Resource m_resource;
+
+		void AddBlock(size_t size);
+	};
+}
@@ -0,0 +1,145 @@
+#include "FramePacer.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include "glm/glm.hpp"
+#include "Profiler.h"
+
+namespace PetGame {
+	static ProfilerCounter s_intervalMean("Frame/Interval mean (us)", ProfilerCounter::Kind::Gauge);
+	static ProfilerCounter s_intervalStdDev("Frame/Interval stddev (us)", ProfilerCounter::Kind::Gauge);
+	static ProfilerCounter s_intervalMax("Frame/Interval max (us)", ProfilerCounter::Kind::Gauge);
+	static ProfilerCounter s_workMean("Frame/Work mean (us)", ProfilerCounter::Kind::Gauge);
+
+	static const double MIN_SPIN_THRESHOLD = 0.0005;
+	static const double MAX_SPIN_THRESHOLD = 0.004;
+
+	FramePacer::FramePacer()
+		: m_vsync(VSyncMode::On),
+		m_targetFps(0.f),
+		m_frameStart(0.0),
+		m_lastFrameEnd(0.0),
+		m_nextDeadline(0.0),
+		m_spinThreshold(0.002),
+		m_intervals(),
+		m_work(),
+		m_sampleIndex(0),
+		m_sampleCount(0),
+		m_intervalMean(0.0),
+		m_intervalStdDev(0.0),
+		m_intervalMax(0.0),
+		m_workMean(0.0)
+	{
+	}
+
+	void FramePacer::setVSync(VSyncMode mode)
+	{
+		m_vsync = mode;
+		if (glfwGetCurrentContext()) {
+			Apply();
+		}
+	}
+
+	void FramePacer::setTargetFps(float fps)
+	{
+		m_targetFps = (fps > 0.f) ? fps : 0.f;
+		m_nextDeadline = 0.0;
+	}
+
+	void FramePacer::Apply()
+	{
+		switch (m_vsync) {
+		case VSyncMode::Off:
+			glfwSwapInterval(0);
+			break;
+		case VSyncMode::On:
+			glfwSwapInterval(1);
+			break;
+		case VSyncMode::Adaptive:
+			if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+				glfwSwapInterval(-1);
+			}
+			else {
+				std::cout << "Adaptive vsync not supported, using vsync on" << std::endl;
+				glfwSwapInterval(1);
+			}
+			break;
+		}
+	}
+
+	void FramePacer::BeginFrame()
+	{
+		m_frameStart = glfwGetTime();
+	}
+
+	void FramePacer::EndFrame()
+	{
+		double workEnd = glfwGetTime();
+
+		if (m_targetFps > 0.f) {
+			double interval = 1.0 / m_targetFps;
+			// Schedule from the previous deadline so the rate does not drift, but never try to catch up
+			m_nextDeadline = (m_nextDeadline + interval < workEnd) ? workEnd : m_nextDeadline + interval;
+			WaitUntil(m_nextDeadline);
+		}
+
+		double frameEnd = glfwGetTime();
+		if (m_lastFrameEnd > 0.0) {
+			m_intervals[m_sampleIndex] = frameEnd - m_lastFrameEnd;
+			m_work[m_sampleIndex] = workEnd - m_frameStart;
+			m_sampleIndex = (m_sampleIndex + 1) % SAMPLE_COUNT;
+			if (m_sampleCount < SAMPLE_COUNT) {
+				m_sampleCount++;
+			}
+			UpdateStats();
+		}
+		m_lastFrameEnd = frameEnd;
+	}
+
+	void FramePacer::WaitUntil(double deadline)
+	{
+		double now = glfwGetTime();
+		double sleepTime = (deadline - now) - m_spinThreshold;
+		if (sleepTime > 0.0) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+
+			// Move the threshold towards the oversleep we just saw so spinning covers the timer slack
+			double oversleep = (glfwGetTime() - now) - sleepTime;
+			double target = glm::clamp(oversleep * 1.5, MIN_SPIN_THRESHOLD, MAX_SPIN_THRESHOLD);
+			m_spinThreshold += (target - m_spinThreshold) * 0.1;
+		}
+
+		while (glfwGetTime() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
+	void FramePacer::UpdateStats()
+	{
+		double intervalSum = 0.0;
+		double workSum = 0.0;
+		double intervalMax = 0.0;
+		for (int i = 0; i < m_sampleCount; i++) {
+			intervalSum += m_intervals[i];
+			workSum += m_work[i];
+			intervalMax = (m_intervals[i] > intervalMax) ? m_intervals[i] : intervalMax;
+		}
+		m_intervalMean = intervalSum / m_sampleCount;
+		m_workMean = workSum / m_sampleCount;
+		m_intervalMax = intervalMax;
+
+		double variance = 0.0;
+		for (int i = 0; i < m_sampleCount; i++) {
+			double diff = m_intervals[i] - m_intervalMean;
+			variance += diff * diff;
+		}
+		m_intervalStdDev = std::sqrt(variance / m_sampleCount);
+
+		s_intervalMean.Set((long long)(m_intervalMean * 1e6));
+		s_intervalStdDev.Set((long long)(m_intervalStdDev * 1e6));
+		s_intervalMax.Set((long long)(m_intervalMax * 1e6));
+		s_workMean.Set((long long)(m_workMean * 1e6));
+	}
+}
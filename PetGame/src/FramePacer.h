@@ -0,0 +1,65 @@
+#pragma once
+
+namespace PetGame {
+	enum class VSyncMode {
+		Off,
+		On,
+		/* Syncs when on time and tears instead of waiting a full interval when late. Falls back to On*/
+		Adaptive,
+	};
+
+	/*
+		Controls the swap interval and limits the frame rate with a hybrid sleep and spin wait.
+		The coarse part of the wait sleeps, the last stretch before the deadline is spun so the
+		frame starts on time even with a low resolution OS timer.
+	*/
+	class FramePacer
+	{
+	public:
+		FramePacer();
+
+		/* Applied right away when a context is current, otherwise on the next Apply*/
+		void setVSync(VSyncMode mode);
+		/* Zero disables the limiter*/
+		void setTargetFps(float fps);
+		void Apply();
+
+		VSyncMode getVSync() const { return m_vsync; };
+		float getTargetFps() const { return m_targetFps; };
+
+		void BeginFrame();
+		/* Records the frame and waits until the next frame deadline*/
+		void EndFrame();
+
+		/* Stats over the last SAMPLE_COUNT frames, in seconds*/
+		double getIntervalMean() const { return m_intervalMean; };
+		double getIntervalStdDev() const { return m_intervalStdDev; };
+		double getIntervalMax() const { return m_intervalMax; };
+		double getWorkMean() const { return m_workMean; };
+
+	private:
+		static const int SAMPLE_COUNT = 120;
+
+		VSyncMode m_vsync;
+		float m_targetFps;
+
+		double m_frameStart;
+		double m_lastFrameEnd;
+		double m_nextDeadline;
+		/* How close to the deadline we stop sleeping and start spinning, tuned from observed oversleep*/
+		double m_spinThreshold;
+
+		double m_intervals[SAMPLE_COUNT];
+		double m_work[SAMPLE_COUNT];
+		int m_sampleIndex;
+		int m_sampleCount;
+
+		double m_intervalMean;
+		double m_intervalStdDev;
+		double m_intervalMax;
+		double m_workMean;
+
+		void WaitUntil(double deadline);
+		void UpdateStats();
+	};
+}
@@ -0,0 +1,27 @@
+#include "FrameUniforms.h"
+#include <glad/glad.h>
+
+namespace PetGame {
+	FrameUniforms::FrameUniforms()
+		: m_ubo(0)
+	{
+		glGenBuffers(1, &m_ubo);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, m_ubo);
+	}
+
+	FrameUniforms::~FrameUniforms()
+	{
+		glDeleteBuffers(1, &m_ubo);
+	}
+
+	void FrameUniforms::Update(const FrameData& data)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, m_ubo);
+	}
+}
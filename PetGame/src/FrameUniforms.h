@@ -0,0 +1,32 @@
+#pragma once
+#include "glm/glm.hpp"
+
+namespace PetGame {
+	/* Uniform block binding point shared by every program that declares the FrameData block*/
+	const unsigned int FRAME_DATA_BINDING = 0;
+	const char* const FRAME_DATA_BLOCK = "FrameData";
+
+	/* Mirrors the std140 FrameData block in the shaders, keep both in sync*/
+	struct FrameData {
+		glm::mat4 projection;
+		glm::mat4 view;
+		/* x: time in seconds, y: frame delta time*/
+		glm::vec4 time;
+		/* x, y: origin, z, w: width and height in pixels*/
+		glm::vec4 viewport;
+	};
+	static_assert(sizeof(FrameData) == 160, "FrameData must match the std140 layout");
+
+	/* Per frame uniform buffer, uploaded once per frame and read by all programs*/
+	class FrameUniforms
+	{
+	public:
+		FrameUniforms();
+		~FrameUniforms();
+
+		void Update(const FrameData& data);
+
+	private:
+		unsigned int m_ubo;
+	};
+}
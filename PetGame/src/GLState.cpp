@@ -0,0 +1,99 @@
+#include "GLState.h"
+#include <glad/glad.h>
+#include "Profiler.h"
+
+namespace PetGame {
+	static ProfilerCounter s_callsIssued("GL/State calls issued", ProfilerCounter::Kind::PerFrame);
+	static ProfilerCounter s_callsSkipped("GL/State calls skipped", ProfilerCounter::Kind::PerFrame);
+
+	unsigned int GLState::s_program = GLState::UNKNOWN;
+	unsigned int GLState::s_activeUnit = GLState::UNKNOWN;
+	unsigned int GLState::s_textures[GLState::MAX_TEXTURE_UNITS] = {};
+	unsigned int GLState::s_textureTargets[GLState::MAX_TEXTURE_UNITS] = {};
+	unsigned int GLState::s_vao = GLState::UNKNOWN;
+
+	void GLState::UseProgram(unsigned int program)
+	{
+		if (s_program == program) {
+			s_callsSkipped.Add();
+			return;
+		}
+		glUseProgram(program);
+		s_program = program;
+		s_callsIssued.Add();
+	}
+
+	void GLState::ActiveTexture(unsigned int unit)
+	{
+		if (s_activeUnit == unit) {
+			s_callsSkipped.Add();
+			return;
+		}
+		glActiveTexture(GL_TEXTURE0 + unit);
+		s_activeUnit = unit;
+		s_callsIssued.Add();
+	}
+
+	void GLState::BindTexture(unsigned int target, unsigned int texture)
+	{
+		unsigned int unit = s_activeUnit;
+		if (unit >= MAX_TEXTURE_UNITS) {
+			// Active unit unknown, pin it down first
+			ActiveTexture(0);
+			unit = 0;
+		}
+		if (s_textures[unit] == texture && s_textureTargets[unit] == target) {
+			s_callsSkipped.Add();
+			return;
+		}
+		glBindTexture(target, texture);
+		s_textures[unit] = texture;
+		s_textureTargets[unit] = target;
+		s_callsIssued.Add();
+	}
+
+	void GLState::BindVertexArray(unsigned int vao)
+	{
+		if (s_vao == vao) {
+			s_callsSkipped.Add();
+			return;
+		}
+		glBindVertexArray(vao);
+		s_vao = vao;
+		s_callsIssued.Add();
+	}
+
+	void GLState::ForgetProgram(unsigned int program)
+	{
+		if (s_program == program) {
+			s_program = UNKNOWN;
+		}
+	}
+
+	void GLState::ForgetTexture(unsigned int texture)
+	{
+		for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+			if (s_textures[unit] == texture) {
+				s_textures[unit] = UNKNOWN;
+			}
+		}
+	}
+
+	void GLState::ForgetVertexArray(unsigned int vao)
+	{
+		if (s_vao == vao) {
+			s_vao = UNKNOWN;
+		}
+	}
+
+	void GLState::Invalidate()
+	{
+		s_program = UNKNOWN;
+		s_activeUnit = UNKNOWN;
+		for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+			s_textures[unit] = UNKNOWN;
+			s_textureTargets[unit] = 0;
+		}
+		s_vao = UNKNOWN;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace PetGame {
+	/*
+		Shadow copy of the GL bindings we use the most. Every bind goes through here and is only
+		forwarded to GL when it actually changes something. Code that touches GL behind our back
+		(ImGui, third party) must be followed by Invalidate.
+	*/
+	class GLState
+	{
+	public:
+		static void UseProgram(unsigned int program);
+		static void ActiveTexture(unsigned int unit);
+		/* Binds on the current active texture unit*/
+		static void BindTexture(unsigned int target, unsigned int texture);
+		static void BindVertexArray(unsigned int vao);
+
+		/* Forget a deleted object so a recycled name is not mistaken for the old binding*/
+		static void ForgetProgram(unsigned int program);
+		static void ForgetTexture(unsigned int texture);
+		static void ForgetVertexArray(unsigned int vao);
+
+		/* Drops every cached value, the next bind of each kind always reaches GL*/
+		static void Invalidate();
+
+	private:
+		static const unsigned int MAX_TEXTURE_UNITS = 16;
+		static const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+		static unsigned int s_program;
+		static unsigned int s_activeUnit;
+		static unsigned int s_textures[MAX_TEXTURE_UNITS];
+		static unsigned int s_textureTargets[MAX_TEXTURE_UNITS];
+		static unsigned int s_vao;
+	};
+}
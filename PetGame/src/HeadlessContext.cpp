@@ -0,0 +1,101 @@
+#include "HeadlessContext.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+namespace PetGame {
+	HeadlessContext::HeadlessContext()
+		: m_display(EGL_NO_DISPLAY),
+		m_context(EGL_NO_CONTEXT)
+	{
+	}
+
+	HeadlessContext::~HeadlessContext()
+	{
+		Destroy();
+	}
+
+	bool HeadlessContext::Create()
+	{
+		// Prefer the surfaceless platform so no X11 or Wayland server is needed
+		EGLDisplay display = EGL_NO_DISPLAY;
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay) {
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		}
+		if (display == EGL_NO_DISPLAY) {
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+
+		EGLint major, minor;
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+			std::cout << "Failed to initialize EGL" << std::endl;
+			return false;
+		}
+		m_display = display;
+
+		const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+		if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+			std::cout << "EGL does not support surfaceless contexts" << std::endl;
+			Destroy();
+			return false;
+		}
+
+		EGLConfig config = EGL_NO_CONFIG_KHR;
+		if (!std::strstr(extensions, "EGL_KHR_no_config_context")) {
+			const EGLint configAttributes[] = {
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_NONE
+			};
+			EGLint count = 0;
+			if (!eglChooseConfig(display, configAttributes, &config, 1, &count) || count == 0) {
+				std::cout << "No suitable EGLConfig" << std::endl;
+				Destroy();
+				return false;
+			}
+		}
+
+		eglBindAPI(EGL_OPENGL_API);
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT) {
+			std::cout << "Failed to create EGL context" << std::endl;
+			Destroy();
+			return false;
+		}
+		m_context = context;
+
+		if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+			std::cout << "Failed to make the EGL context current" << std::endl;
+			Destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void HeadlessContext::Destroy()
+	{
+		if (m_display == EGL_NO_DISPLAY) {
+			return;
+		}
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (m_context != EGL_NO_CONTEXT) {
+			eglDestroyContext(m_display, m_context);
+			m_context = EGL_NO_CONTEXT;
+		}
+		eglTerminate(m_display);
+		m_display = EGL_NO_DISPLAY;
+	}
+
+	void* HeadlessContext::GetProcAddress(const char* name)
+	{
+		return (void*)eglGetProcAddress(name);
+	}
+}
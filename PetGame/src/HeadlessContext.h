@@ -0,0 +1,29 @@
+#pragma once
+
+namespace PetGame {
+	/*
+		OpenGL 3.3 core context without a window or display server, through EGL surfaceless
+		(Mesa llvmpipe works on GPU-less machines). There is no default framebuffer, everything has
+		to be drawn into a RenderTarget.
+	*/
+	class HeadlessContext
+	{
+	public:
+		HeadlessContext();
+		~HeadlessContext();
+
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+		/* Creates the context and makes it current on the calling thread*/
+		bool Create();
+		void Destroy();
+
+		/* Loader for glad and the ShaderCache, same signature as glfwGetProcAddress*/
+		static void* GetProcAddress(const char* name);
+
+	private:
+		void* m_display;
+		void* m_context;
+	};
+}
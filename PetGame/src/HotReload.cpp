@@ -0,0 +1,131 @@
+#include "HotReload.h"
+#include <GLFW/glfw3.h>
+#include <filesystem>
+#include <iostream>
+#include "stb_image.h"
+#include "Profiler.h"
+#include "AllocationCounter.h"
+
+namespace PetGame {
+	static ProfilerCounter s_shadersReloaded("Reload/Shaders");
+	static ProfilerCounter s_texturesReloaded("Reload/Textures");
+
+	static bool HasExtension(const std::string& filePath, const char* extension)
+	{
+		return std::filesystem::path(filePath).extension() == extension;
+	}
+
+	HotReload::HotReload(ShaderRegistry& shaders, TextureCache& textures)
+		: m_shaders(shaders),
+		m_textures(textures),
+		m_root("."),
+		m_hasPending(false)
+	{
+	}
+
+	HotReload::~HotReload()
+	{
+		Stop();
+	}
+
+	void HotReload::Start()
+	{
+#ifdef PETGAME_SOURCE_DIR
+		// The working directory only has copies made after the build, edit the originals instead
+		if (std::filesystem::is_directory(PETGAME_SOURCE_DIR "/shaders")) {
+			m_root = PETGAME_SOURCE_DIR;
+		}
+#endif
+		m_watcher.Watch(m_root + "/shaders");
+		m_watcher.Watch(m_root + "/assets");
+		if (m_watcher.Start([this](const std::string& watchedPath) { OnFileChanged(watchedPath); })) {
+			std::cout << "Hot reload watching " << m_root << std::endl;
+		}
+	}
+
+	void HotReload::Stop()
+	{
+		m_watcher.Stop();
+	}
+
+	void HotReload::OnFileChanged(const std::string& watchedPath)
+	{
+		AllocationScope allocationScope(AllocationTag::Assets);
+		PendingReload reload;
+		reload.filePath = watchedPath.substr(m_root.size() + 1);
+
+		if (HasExtension(watchedPath, ".png")) {
+			// The flip flag is global in stb_image, use the per thread override so the GL thread is not affected
+			stbi_set_flip_vertically_on_load_thread(true);
+			unsigned char* data = stbi_load(watchedPath.c_str(), &reload.width, &reload.height, &reload.channels, 0);
+			if (!data) {
+				std::cout << "Hot reload failed to decode " << watchedPath << std::endl;
+				return;
+			}
+			reload.pixels.assign(data, data + (size_t)reload.width * reload.height * reload.channels);
+			stbi_image_free(data);
+		}
+		else if (HasExtension(watchedPath, ".vert") || HasExtension(watchedPath, ".frag")) {
+			if (!Shader::ReadSource(watchedPath.c_str(), reload.source)) {
+				return;
+			}
+		}
+		else {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// Editors often write twice in a row, only the newest content matters
+			bool replaced = false;
+			for (PendingReload& pending : m_pending) {
+				if (pending.filePath == reload.filePath) {
+					pending = std::move(reload);
+					replaced = true;
+					break;
+				}
+			}
+			if (!replaced) {
+				m_pending.push_back(std::move(reload));
+			}
+			m_hasPending.store(true, std::memory_order_release);
+		}
+		// Wake a render on demand loop that is sleeping in glfwWaitEvents
+		glfwPostEmptyEvent();
+	}
+
+	bool HotReload::Apply()
+	{
+		if (!m_hasPending.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		AllocationScope allocationScope(AllocationTag::Assets);
+		PendingReload reload;
+		{
+			// Never stall the frame on the watcher, try again next frame instead
+			std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+			if (!lock.owns_lock() || m_pending.empty()) {
+				return false;
+			}
+			reload = std::move(m_pending.front());
+			m_pending.erase(m_pending.begin());
+			m_hasPending.store(!m_pending.empty(), std::memory_order_release);
+		}
+
+		if (reload.pixels.empty()) {
+			int reloaded = m_shaders.ReloadSource(reload.filePath, reload.source);
+			s_shadersReloaded.Add(reloaded);
+			std::cout << "Reloaded " << reload.filePath << " in " << reloaded << " program(s)" << std::endl;
+		}
+		else {
+			// Files nobody loaded yet are picked up by the first Load
+			Texture2D* texture = m_textures.Find(reload.filePath);
+			if (texture && texture->Upload(reload.width, reload.height, reload.channels, reload.pixels.data())) {
+				s_texturesReloaded.Add();
+				std::cout << "Reloaded " << reload.filePath << std::endl;
+			}
+		}
+		return true;
+	}
+}
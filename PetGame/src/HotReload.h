@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "FileWatcher.h"
+#include "ShaderRegistry.h"
+#include "TextureCache.h"
+
+namespace PetGame {
+	/*
+		Recompiles shaders and re-uploads textures when their files change on disk.
+		Files are read and PNGs decoded on the watcher thread, the GL thread only swaps the
+		results in from Apply, so a reload never blocks a frame on disk or decoding.
+		Programs are relinked and textures refilled in place, handles and Texture2D pointers keep working.
+	*/
+	class HotReload
+	{
+	public:
+		HotReload(ShaderRegistry& shaders, TextureCache& textures);
+		~HotReload();
+
+		/* Watches shaders/ and assets/, in the source tree when it is around so edits skip the post build copy*/
+		void Start();
+		void Stop();
+
+		/* GL thread, once per frame. Applies at most one pending reload, returns true when one was taken*/
+		bool Apply();
+
+	private:
+		struct PendingReload {
+			/* Path as the registry and the cache know it, e.g. shaders/sprite.frag*/
+			std::string filePath;
+			std::string source;
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+			std::vector<unsigned char> pixels;
+		};
+
+		ShaderRegistry& m_shaders;
+		TextureCache& m_textures;
+		FileWatcher m_watcher;
+		std::string m_root;
+
+		std::mutex m_mutex;
+		std::vector<PendingReload> m_pending;
+		std::atomic<bool> m_hasPending;
+
+		/* Watcher thread*/
+		void OnFileChanged(const std::string& watchedPath);
+	};
+}
@@ -0,0 +1,12 @@
+#include "IState.h"
+
+namespace PetGame {
+	namespace DigiPet {
+		int IState::advance(Pet* pet, float deltaTime, int tick, int ticks)
+		{
+			// Single step, the state may be replaced during update
+			update(pet, deltaTime, tick);
+			return 1;
+		}
+	}
+}
@@ -1,5 +1,5 @@
 #pragma once 
-#include <string>
+#include <string_view>
 
 namespace PetGame {
 	namespace DigiPet {
@@ -16,9 +16,12 @@ namespace PetGame {
 
 			virtual void enter(Pet* pet, int tick = NULL) = 0;
 			virtual void update(Pet* pet, float deltaTime, int tick) = 0;
+			/* Advances up to ticks ticks at once and returns how many were consumed. Defaults to a single update*/
+			virtual int advance(Pet* pet, float deltaTime, int tick, int ticks);
 			virtual void leave(Pet* pet, int tick = NULL) = 0;
 
-			virtual std::string getCurrentActivity(const Pet* pet) const = 0;
+			/* What the pet is doing, printed after its name*/
+			virtual std::string_view getCurrentActivity(const Pet* pet) const = 0;
 		};
 	}
 }
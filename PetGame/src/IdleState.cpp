@@ -4,29 +4,29 @@
 
 namespace PetGame {
 	namespace DigiPet {
-		IdleState::IdleState() :m_lastHungerTick(0) {
+		IdleState::IdleState() {
 		}
 		IdleState::~IdleState() {}
 		void IdleState::enter(Pet* pet, int tick) {
 			std::cout << pet->getName() << "Is idle" << std::endl;
-			m_lastHungerTick = tick;
+			// The hunger itself is added by PetVitals::Tick for all pets at once
+			pet->setHungerDecay(TICKS_TO_HUNGER, tick);
 		}
 		void IdleState::update(Pet* pet, float deltaTime, int currentTick) {
-			int ticksSinceLastHunger = currentTick - m_lastHungerTick;
-			if (ticksSinceLastHunger >= TICKS_TO_HUNGER) {
-				m_lastHungerTick = currentTick;
-				pet->setHunger(pet->getHunger() + 1);
-				std::cout << pet->getName() << " got a bit hungrier..." << std::endl;
-			}
+		}
+		int IdleState::advance(Pet* pet, float deltaTime, int tick, int ticks) {
+			// Nothing happens per pet while idle, so any number of ticks is consumed at once
+			return ticks;
 		}
 		void IdleState::leave(Pet* pet, int tick) {
 			std::cout << pet->getName() << " is no longer Idle." << std::endl;
+			pet->setHungerDecay(0, tick);
 
 		}
 
-		std::string IdleState::getCurrentActivity(const Pet* pet) const
+		std::string_view IdleState::getCurrentActivity(const Pet* pet) const
 		{
-			return pet->getName() + " is idling around...";
+			return "is idling around...";
 		}
 
 	}
@@ -12,13 +12,10 @@ namespace PetGame {
 
 			void enter( Pet* pet, int tick= NULL) override;
 			void update( Pet* pet, float deltaTime, int tick) override;
+			int advance(Pet* pet, float deltaTime, int tick, int ticks) override;
 			void leave( Pet* pet, int tick = NULL) override;
 
-			std::string getCurrentActivity(const Pet* pet) const override;
-
-		private:
-			int m_lastHungerTick;
-
+			std::string_view getCurrentActivity(const Pet* pet) const override;
 		};
 
 	}
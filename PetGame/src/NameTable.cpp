@@ -0,0 +1,37 @@
+#include "NameTable.h"
+
+namespace PetGame {
+	NameTable& NameTable::Instance()
+	{
+		static NameTable table;
+		return table;
+	}
+
+	NameId NameTable::Intern(std::string_view name)
+	{
+		NameTable& table = Instance();
+		std::lock_guard<std::mutex> lock(table.m_mutex);
+		auto found = table.m_ids.find(name);
+		if (found != table.m_ids.end()) {
+			return found->second;
+		}
+		NameId id = (NameId)table.m_names.size();
+		const std::string& stored = table.m_names.emplace_back(name);
+		table.m_ids.emplace(std::string_view(stored), id);
+		return id;
+	}
+
+	std::string_view NameTable::Get(NameId id)
+	{
+		NameTable& table = Instance();
+		std::lock_guard<std::mutex> lock(table.m_mutex);
+		return (id < table.m_names.size()) ? std::string_view(table.m_names[id]) : std::string_view();
+	}
+
+	size_t NameTable::getCount()
+	{
+		NameTable& table = Instance();
+		std::lock_guard<std::mutex> lock(table.m_mutex);
+		return table.m_names.size();
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace PetGame {
+	using NameId = uint32_t;
+
+	/*
+		Process wide table of interned names. Every distinct name is stored once and gets a 32 bit id,
+		views into the table stay valid until the process ends, so they can be kept and passed across
+		threads without copying. Interning locks, looking up an id only locks to read the table.
+	*/
+	class NameTable
+	{
+	public:
+		static NameId Intern(std::string_view name);
+		static std::string_view Get(NameId id);
+		static size_t getCount();
+
+	private:
+		/* A deque never moves its elements, so the views into them stay valid as it grows*/
+		std::deque<std::string> m_names;
+		std::unordered_map<std::string_view, NameId> m_ids;
+		mutable std::mutex m_mutex;
+
+		static NameTable& Instance();
+	};
+}
@@ -0,0 +1,163 @@
+#include "PetVitals.h"
+#include <algorithm>
+#include "CpuFeatures.h"
+#include "Profiler.h"
+
+#if defined(PETGAME_X86)
+#include <immintrin.h>
+#endif
+
+namespace PetGame {
+	static ProfilerCounter s_vitalsTicked("Sim/Vitals ticked");
+
+	struct VitalsArrays {
+		int32_t* hunger;
+		int32_t* experience;
+		const int32_t* hungerRate;
+		const int32_t* experienceRate;
+		const int32_t* hungerInterval;
+		int32_t* nextHungerTick;
+	};
+
+	using VitalsKernel = void(*)(const VitalsArrays& vitals, size_t count, int32_t tick, int32_t minHunger, int32_t maxHunger);
+
+	static void TickScalar(const VitalsArrays& vitals, size_t begin, size_t end, int32_t tick, int32_t minHunger, int32_t maxHunger)
+	{
+		for (size_t i = begin; i < end; i++) {
+			int32_t hunger = vitals.hunger[i] + vitals.hungerRate[i];
+			if (vitals.hungerInterval[i] > 0 && tick >= vitals.nextHungerTick[i]) {
+				hunger++;
+				vitals.nextHungerTick[i] = tick + vitals.hungerInterval[i];
+			}
+			vitals.hunger[i] = std::clamp(hunger, minHunger, maxHunger);
+			vitals.experience[i] = std::max(vitals.experience[i] + vitals.experienceRate[i], 0);
+		}
+	}
+
+	static void TickKernelScalar(const VitalsArrays& vitals, size_t count, int32_t tick, int32_t minHunger, int32_t maxHunger)
+	{
+		TickScalar(vitals, 0, count, tick, minHunger, maxHunger);
+	}
+
+#if defined(PETGAME_X86)
+	// The comparisons give all ones lanes, so subtracting the due mask adds the idle hunger point
+	PETGAME_TARGET("sse4.1")
+	static void TickKernelSSE41(const VitalsArrays& vitals, size_t count, int32_t tick, int32_t minHunger, int32_t maxHunger)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i tickLanes = _mm_set1_epi32(tick);
+		const __m128i minLanes = _mm_set1_epi32(minHunger);
+		const __m128i maxLanes = _mm_set1_epi32(maxHunger);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i hunger = _mm_loadu_si128((const __m128i*)(vitals.hunger + i));
+			__m128i rate = _mm_loadu_si128((const __m128i*)(vitals.hungerRate + i));
+			__m128i interval = _mm_loadu_si128((const __m128i*)(vitals.hungerInterval + i));
+			__m128i next = _mm_loadu_si128((const __m128i*)(vitals.nextHungerTick + i));
+			__m128i due = _mm_andnot_si128(_mm_cmpgt_epi32(next, tickLanes), _mm_cmpgt_epi32(interval, zero));
+
+			hunger = _mm_sub_epi32(_mm_add_epi32(hunger, rate), due);
+			hunger = _mm_min_epi32(_mm_max_epi32(hunger, minLanes), maxLanes);
+			next = _mm_blendv_epi8(next, _mm_add_epi32(tickLanes, interval), due);
+			_mm_storeu_si128((__m128i*)(vitals.hunger + i), hunger);
+			_mm_storeu_si128((__m128i*)(vitals.nextHungerTick + i), next);
+
+			__m128i experience = _mm_loadu_si128((const __m128i*)(vitals.experience + i));
+			__m128i experienceRate = _mm_loadu_si128((const __m128i*)(vitals.experienceRate + i));
+			experience = _mm_max_epi32(_mm_add_epi32(experience, experienceRate), zero);
+			_mm_storeu_si128((__m128i*)(vitals.experience + i), experience);
+		}
+		TickScalar(vitals, i, count, tick, minHunger, maxHunger);
+	}
+
+	PETGAME_TARGET("avx2")
+	static void TickKernelAVX2(const VitalsArrays& vitals, size_t count, int32_t tick, int32_t minHunger, int32_t maxHunger)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i tickLanes = _mm256_set1_epi32(tick);
+		const __m256i minLanes = _mm256_set1_epi32(minHunger);
+		const __m256i maxLanes = _mm256_set1_epi32(maxHunger);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i hunger = _mm256_loadu_si256((const __m256i*)(vitals.hunger + i));
+			__m256i rate = _mm256_loadu_si256((const __m256i*)(vitals.hungerRate + i));
+			__m256i interval = _mm256_loadu_si256((const __m256i*)(vitals.hungerInterval + i));
+			__m256i next = _mm256_loadu_si256((const __m256i*)(vitals.nextHungerTick + i));
+			__m256i due = _mm256_andnot_si256(_mm256_cmpgt_epi32(next, tickLanes), _mm256_cmpgt_epi32(interval, zero));
+
+			hunger = _mm256_sub_epi32(_mm256_add_epi32(hunger, rate), due);
+			hunger = _mm256_min_epi32(_mm256_max_epi32(hunger, minLanes), maxLanes);
+			next = _mm256_blendv_epi8(next, _mm256_add_epi32(tickLanes, interval), due);
+			_mm256_storeu_si256((__m256i*)(vitals.hunger + i), hunger);
+			_mm256_storeu_si256((__m256i*)(vitals.nextHungerTick + i), next);
+
+			__m256i experience = _mm256_loadu_si256((const __m256i*)(vitals.experience + i));
+			__m256i experienceRate = _mm256_loadu_si256((const __m256i*)(vitals.experienceRate + i));
+			experience = _mm256_max_epi32(_mm256_add_epi32(experience, experienceRate), zero);
+			_mm256_storeu_si256((__m256i*)(vitals.experience + i), experience);
+		}
+		TickScalar(vitals, i, count, tick, minHunger, maxHunger);
+	}
+#endif
+
+	static VitalsKernel SelectTickKernel()
+	{
+#if defined(PETGAME_X86)
+		switch (getSimdLevel()) {
+		case SimdLevel::AVX2: return TickKernelAVX2;
+		case SimdLevel::SSE41: return TickKernelSSE41;
+		default: break;
+		}
+#endif
+		return TickKernelScalar;
+	}
+
+	uint32_t PetVitals::Add(const PetVitalsRow& row)
+	{
+		for (size_t field = 0; field < row.size(); field++) {
+			m_fields[field].push_back(row[field]);
+		}
+		return (uint32_t)(getCount() - 1);
+	}
+
+	void PetVitals::RemoveSwap(uint32_t row)
+	{
+		for (std::vector<int32_t>& values : m_fields) {
+			values[row] = values.back();
+			values.pop_back();
+		}
+	}
+
+	void PetVitals::Clear()
+	{
+		for (std::vector<int32_t>& values : m_fields) {
+			values.clear();
+		}
+	}
+
+	PetVitalsRow PetVitals::getRow(uint32_t row) const
+	{
+		PetVitalsRow values;
+		for (size_t field = 0; field < values.size(); field++) {
+			values[field] = m_fields[field][row];
+		}
+		return values;
+	}
+
+	void PetVitals::Tick(int32_t tick, int32_t minHunger, int32_t maxHunger)
+	{
+		static const VitalsKernel kernel = SelectTickKernel();
+
+		VitalsArrays vitals;
+		vitals.hunger = m_fields[(size_t)PetVital::Hunger].data();
+		vitals.experience = m_fields[(size_t)PetVital::Experience].data();
+		vitals.hungerRate = m_fields[(size_t)PetVital::HungerRate].data();
+		vitals.experienceRate = m_fields[(size_t)PetVital::ExperienceRate].data();
+		vitals.hungerInterval = m_fields[(size_t)PetVital::HungerInterval].data();
+		vitals.nextHungerTick = m_fields[(size_t)PetVital::NextHungerTick].data();
+		kernel(vitals, getCount(), tick, minHunger, maxHunger);
+		s_vitalsTicked.Add((long long)getCount());
+	}
+}
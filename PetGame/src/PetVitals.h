@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PetGame {
+	/* Per pet values the vitals kernels work on, every field is one int32 array*/
+	enum class PetVital {
+		Hunger,
+		Experience,
+		/* Added every tick, e.g. negative while eating*/
+		HungerRate,
+		ExperienceRate,
+		/* Ticks between two idle hunger points, zero when the pet does not get hungry on its own*/
+		HungerInterval,
+		NextHungerTick,
+		Count,
+	};
+
+	using PetVitalsRow = std::array<int32_t, (size_t)PetVital::Count>;
+
+	/*
+		Hunger and experience of every pet as a structure of arrays, so one tick of the whole world
+		is a handful of vector instructions per 8 pets instead of a virtual call per pet.
+		Rows are packed like the PetWorld dense order and removed by moving the last row into the hole.
+	*/
+	class PetVitals
+	{
+	public:
+		uint32_t Add(const PetVitalsRow& row);
+		/* Moves the last row into row, like PetWorld::Destroy does with the pets*/
+		void RemoveSwap(uint32_t row);
+		void Clear();
+
+		size_t getCount() const { return m_fields[0].size(); };
+		int32_t get(PetVital field, uint32_t row) const { return m_fields[(size_t)field][row]; };
+		void set(PetVital field, uint32_t row, int32_t value) { m_fields[(size_t)field][row] = value; };
+		PetVitalsRow getRow(uint32_t row) const;
+
+		/*
+			Runs one tick for every row: adds the rates and the due idle hunger, clamps hunger to
+			[minHunger, maxHunger] and keeps experience at zero or above. Uses the widest SIMD path
+			the CPU supports
+		*/
+		void Tick(int32_t tick, int32_t minHunger, int32_t maxHunger);
+
+	private:
+		std::vector<int32_t> m_fields[(size_t)PetVital::Count];
+	};
+}
@@ -0,0 +1,111 @@
+#include "PetWorld.h"
+
+namespace PetGame {
+	PetWorld::PetWorld(float gridCellSize)
+		: m_freeHead(PetHandle::INVALID),
+		m_grid(gridCellSize)
+	{
+	}
+
+	PetHandle PetWorld::Create(std::unique_ptr<DigiPet::Pet> pet)
+	{
+		uint32_t slotIndex;
+		if (m_freeHead != PetHandle::INVALID) {
+			slotIndex = m_freeHead;
+			m_freeHead = m_slots[slotIndex].dense;
+		}
+		else {
+			slotIndex = (uint32_t)m_slots.size();
+			m_slots.push_back({ 0, 0, false });
+		}
+		m_grid.Insert(slotIndex, pet->getPosition(), pet->getSize() * 0.5f);
+
+		Slot& slot = m_slots[slotIndex];
+		slot.dense = (uint32_t)m_pets.size();
+		slot.alive = true;
+		pet->AttachVitals(&m_vitals, m_vitals.Add(pet->getVitalsRow()));
+		m_pets.push_back(std::move(pet));
+		m_denseToSlot.push_back(slotIndex);
+
+		PetHandle handle;
+		handle.index = slotIndex;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	bool PetWorld::Destroy(PetHandle handle)
+	{
+		if (!Get(handle)) {
+			return false;
+		}
+
+		m_grid.Remove(handle.index);
+		Slot& slot = m_slots[handle.index];
+		uint32_t last = (uint32_t)m_pets.size() - 1;
+		// The pet gets its own copy of the vitals, its destructor still runs the state leave
+		m_pets[slot.dense]->DetachVitals();
+		m_vitals.RemoveSwap(slot.dense);
+		if (slot.dense != last) {
+			m_pets[slot.dense] = std::move(m_pets[last]);
+			m_pets[slot.dense]->AttachVitals(&m_vitals, slot.dense);
+			m_denseToSlot[slot.dense] = m_denseToSlot[last];
+			m_slots[m_denseToSlot[slot.dense]].dense = slot.dense;
+		}
+		m_pets.pop_back();
+		m_denseToSlot.pop_back();
+
+		// A new generation invalidates every handle still pointing at this slot
+		slot.generation++;
+		slot.alive = false;
+		slot.dense = m_freeHead;
+		m_freeHead = handle.index;
+		return true;
+	}
+
+	void PetWorld::Clear()
+	{
+		while (!m_pets.empty()) {
+			Destroy(getHandle(m_pets.size() - 1));
+		}
+	}
+
+	DigiPet::Pet* PetWorld::Get(PetHandle handle) const
+	{
+		if (handle.index >= m_slots.size()) {
+			return nullptr;
+		}
+		const Slot& slot = m_slots[handle.index];
+		if (!slot.alive || slot.generation != handle.generation) {
+			return nullptr;
+		}
+		return m_pets[slot.dense].get();
+	}
+
+	PetHandle PetWorld::getHandleOfSlot(uint32_t slot) const
+	{
+		PetHandle handle;
+		if (slot < m_slots.size() && m_slots[slot].alive) {
+			handle.index = slot;
+			handle.generation = m_slots[slot].generation;
+		}
+		return handle;
+	}
+
+	void PetWorld::UpdatePosition(size_t i)
+	{
+		m_grid.Move(m_denseToSlot[i], m_pets[i]->getPosition());
+	}
+
+	void PetWorld::TickVitals(int tick)
+	{
+		m_vitals.Tick(tick, DigiPet::CONFIG::MIN_HUNGER, DigiPet::CONFIG::MAX_HUNGER);
+	}
+
+	PetHandle PetWorld::getHandle(size_t i) const
+	{
+		PetHandle handle;
+		handle.index = m_denseToSlot[i];
+		handle.generation = m_slots[handle.index].generation;
+		return handle;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "DigiPet.h"
+#include "PetVitals.h"
+#include "SpatialGrid.h"
+
+namespace PetGame {
+	/*
+		Stable reference to a pet in a PetWorld. The generation makes a handle to a destroyed pet
+		invalid even after its slot was reused, so handles can be stored anywhere.
+	*/
+	struct PetHandle {
+		static const uint32_t INVALID = 0xFFFFFFFF;
+
+		uint32_t index = INVALID;
+		uint32_t generation = 0;
+
+		bool isValid() const { return index != INVALID; };
+		/* Both fields packed in one value, e.g. for ids and save files*/
+		uint64_t getValue() const { return ((uint64_t)generation << 32) | index; };
+		bool operator==(const PetHandle& other) const { return index == other.index && generation == other.generation; };
+		bool operator!=(const PetHandle& other) const { return !(*this == other); };
+	};
+
+	/*
+		Owns every pet in a generational slot map. Create and Destroy are O(1), live pets are kept
+		packed so iterating them never touches empty slots. Destroy moves the last pet into the
+		hole, so the dense order changes but handles stay valid.
+		Pet positions are mirrored in a SpatialGrid keyed by slot, call UpdatePosition after a pet moved.
+		Hunger and experience live in PetVitals rows that follow the dense order.
+		Not thread safe, only the thread running the simulation may use it once it started.
+	*/
+	class PetWorld
+	{
+	public:
+		explicit PetWorld(float gridCellSize = 128.f);
+		~PetWorld() = default;
+
+		PetWorld(const PetWorld&) = delete;
+		PetWorld& operator=(const PetWorld&) = delete;
+
+		PetHandle Create(std::unique_ptr<DigiPet::Pet> pet);
+		bool Destroy(PetHandle handle);
+		void Clear();
+
+		/* Null for stale or invalid handles*/
+		DigiPet::Pet* Get(PetHandle handle) const;
+		bool isAlive(PetHandle handle) const { return Get(handle) != nullptr; };
+
+		/* Dense access, i goes from 0 to getCount() - 1*/
+		size_t getCount() const { return m_pets.size(); };
+		DigiPet::Pet& getPet(size_t i) const { return *m_pets[i]; };
+		PetHandle getHandle(size_t i) const;
+		/* Handle of the live pet in a slot, invalid when the slot is free*/
+		PetHandle getHandleOfSlot(uint32_t slot) const;
+
+		/* Brings the grid up to date with the position of dense pet i*/
+		void UpdatePosition(size_t i);
+		const SpatialGrid& getGrid() const { return m_grid; };
+
+		/* Row i belongs to dense pet i*/
+		PetVitals& getVitals() { return m_vitals; };
+		/* Runs the vitals of every pet for one tick, clamped to the pet hunger range*/
+		void TickVitals(int tick);
+
+	private:
+		struct Slot {
+			uint32_t generation;
+			/* Position in m_pets while alive, next free slot otherwise*/
+			uint32_t dense;
+			bool alive;
+		};
+
+		/* Declared before m_pets so it outlives them, pets still write their vitals when they are destroyed*/
+		PetVitals m_vitals;
+		std::vector<std::unique_ptr<DigiPet::Pet>> m_pets;
+		/* Slot of every dense entry, parallel to m_pets*/
+		std::vector<uint32_t> m_denseToSlot;
+		std::vector<Slot> m_slots;
+		uint32_t m_freeHead;
+		SpatialGrid m_grid;
+	};
+}
@@ -0,0 +1,56 @@
+#include "Profiler.h"
+#include "imgui.h"
+
+namespace PetGame {
+	ProfilerCounter::ProfilerCounter(const char* name, Kind kind)
+		: m_name(name),
+		m_kind(kind),
+		m_value(0),
+		m_lastFrame(0)
+	{
+		Profiler::Register(this);
+	}
+
+	long long ProfilerCounter::getValue() const
+	{
+		if (m_kind == Kind::PerFrame) {
+			return m_lastFrame.load(std::memory_order_relaxed);
+		}
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	std::vector<ProfilerCounter*>& Profiler::Counters()
+	{
+		// Function local so counters defined as statics in other files can register safely
+		static std::vector<ProfilerCounter*> counters;
+		return counters;
+	}
+
+	void Profiler::Register(ProfilerCounter* counter)
+	{
+		Counters().push_back(counter);
+	}
+
+	void Profiler::EndFrame()
+	{
+		for (ProfilerCounter* counter : Counters()) {
+			if (counter->m_kind == ProfilerCounter::Kind::PerFrame) {
+				counter->m_lastFrame.store(counter->m_value.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void Profiler::DrawOverlay(bool* open)
+	{
+		ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+		ImGui::SetNextWindowBgAlpha(0.6f);
+		if (ImGui::Begin("Profiler", open, ImGuiWindowFlags_AlwaysAutoResize)) {
+			ImGui::Text("%.2f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+			ImGui::Separator();
+			for (const ProfilerCounter* counter : Counters()) {
+				ImGui::Text("%s: %lld", counter->getName(), counter->getValue());
+			}
+		}
+		ImGui::End();
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+namespace PetGame {
+	/*
+		Named counter shown in the profiler overlay. Counters are usually static objects owned by
+		the subsystem that updates them and can be bumped from any thread.
+		PerFrame counters are latched and reset by Profiler::EndFrame.
+	*/
+	class ProfilerCounter
+	{
+	public:
+		enum Kind {
+			Total,
+			PerFrame,
+			Gauge,
+		};
+
+		ProfilerCounter(const char* name, Kind kind = Kind::Total);
+
+		void Add(long long value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); };
+		void Set(long long value) { m_value.store(value, std::memory_order_relaxed); };
+
+		const char* getName() const { return m_name; };
+		Kind getKind() const { return m_kind; };
+		long long getValue() const;
+
+	private:
+		friend class Profiler;
+
+		const char* m_name;
+		Kind m_kind;
+		std::atomic<long long> m_value;
+		std::atomic<long long> m_lastFrame;
+	};
+
+	class Profiler
+	{
+	public:
+		static void Register(ProfilerCounter* counter);
+		static const std::vector<ProfilerCounter*>& getCounters() { return Counters(); };
+
+		/* Called once per rendered frame, after the swap*/
+		static void EndFrame();
+
+		static void DrawOverlay(bool* open);
+
+	private:
+		static std::vector<ProfilerCounter*>& Counters();
+	};
+}
@@ -0,0 +1,49 @@
+#include "RadixSort.h"
+#include <utility>
+
+namespace PetGame {
+	static const int RADIX_BITS = 8;
+	static const int BUCKETS = 1 << RADIX_BITS;
+	static const int PASSES = 64 / RADIX_BITS;
+
+	void RadixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch, int firstBit)
+	{
+		size_t count = keys.size();
+		if (count < 2) {
+			return;
+		}
+		scratch.resize(count);
+
+		int firstPass = firstBit / RADIX_BITS;
+
+		// All histograms in one read over the keys
+		size_t histograms[PASSES][BUCKETS] = {};
+		for (uint64_t key : keys) {
+			for (int pass = firstPass; pass < PASSES; pass++) {
+				histograms[pass][(key >> (pass * RADIX_BITS)) & (BUCKETS - 1)]++;
+			}
+		}
+
+		for (int pass = firstPass; pass < PASSES; pass++) {
+			size_t* histogram = histograms[pass];
+			int shift = pass * RADIX_BITS;
+			if (histogram[(keys[0] >> shift) & (BUCKETS - 1)] == count) {
+				continue;
+			}
+
+			// Counts to start offsets
+			size_t offset = 0;
+			for (int bucket = 0; bucket < BUCKETS; bucket++) {
+				size_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			uint64_t* target = scratch.data();
+			for (uint64_t key : keys) {
+				target[histogram[(key >> shift) & (BUCKETS - 1)]++] = key;
+			}
+			keys.swap(scratch);
+		}
+	}
+}
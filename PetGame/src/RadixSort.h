@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace PetGame {
+	/*
+		Ascending LSD radix sort of 64 bit keys, one byte per pass. Passes where every key has the
+		same byte, e.g. unused or constant key fields, are skipped after a single counting pass.
+		Only the bits from firstBit up (a multiple of 8) are compared and the sort is stable, so keys
+		that carry their submission index in the low bits are pushed in order and skip those passes.
+		scratch is resized to the key count and may be swapped with keys, reusing both vectors
+		between calls keeps the sort free of allocations.
+	*/
+	void RadixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch, int firstBit = 0);
+
+	/* Maps a float to an unsigned value with the same ordering, for packing into sort keys*/
+	inline uint32_t SortableFloat(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		// Negative floats order backwards, flip all of them, positives only need the sign set
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+}
@@ -0,0 +1,60 @@
+#include "RenderSnapshot.h"
+
+namespace PetGame {
+	SpriteInstance SpriteInstance::Interpolated(float alpha) const
+	{
+		SpriteInstance result = *this;
+		result.position = glm::mix(previousPosition, position, alpha);
+		result.rotation = glm::mix(previousRotation, rotation, alpha);
+		return result;
+	}
+
+	float RenderSnapshot::getAlpha(double time) const
+	{
+		float elapsed = motionRemainder + (float)(time - simTime);
+		return glm::clamp(elapsed / motionTickDuration, 0.f, 1.f);
+	}
+
+	const PetStatus* RenderSnapshot::FindStatus(PetHandle pet) const
+	{
+		for (const PetStatus& status : statuses) {
+			if (status.pet == pet) {
+				return &status;
+			}
+		}
+		return nullptr;
+	}
+
+	bool RenderSnapshot::hasMotion() const
+	{
+		for (const SpriteInstance& sprite : sprites) {
+			if (sprite.position != sprite.previousPosition || sprite.rotation != sprite.previousRotation) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	SnapshotBuffer::SnapshotBuffer()
+		: m_middle(1),
+		m_back(0),
+		m_front(2)
+	{
+	}
+
+	void SnapshotBuffer::Publish()
+	{
+		int previous = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel);
+		m_back = previous & INDEX_MASK;
+	}
+
+	bool SnapshotBuffer::Acquire()
+	{
+		if (!(m_middle.load(std::memory_order_relaxed) & FRESH_BIT)) {
+			return false;
+		}
+		int middle = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = middle & INDEX_MASK;
+		return true;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Texture2D.h"
+#include "SpriteAnimation.h"
+#include "PetWorld.h"
+
+namespace PetGame {
+	/* Draw order of sprites, lower layers are drawn first whatever order they were submitted in*/
+	enum class SpriteLayer : uint8_t {
+		Ground,
+		Shadows,
+		/* Pets and props, sorted back to front by y so lower sprites overlap higher ones*/
+		Objects,
+		Effects,
+		Overlay,
+	};
+
+	/* Everything the renderer needs to draw one sprite, copied out of the simulation*/
+	struct SpriteInstance {
+		PetHandle pet;
+		SpriteLayer layer = SpriteLayer::Objects;
+		Texture2D* texture = nullptr;
+		/* Drawn instead of the texture when set*/
+		SpriteAnimation* animation = nullptr;
+		/* Render clock time the animation started at*/
+		float animationStart = 0.f;
+		glm::vec2 position = glm::vec2(0.f);
+		glm::vec2 previousPosition = glm::vec2(0.f);
+		glm::vec2 size = glm::vec2(0.f);
+		float rotation = 0.f;
+		float previousRotation = 0.f;
+		glm::vec3 color = glm::vec3(1.f);
+
+		/* Transform blended between the previous and the current motion tick*/
+		SpriteInstance Interpolated(float alpha) const;
+	};
+
+	/* Pet data shown by the UI*/
+	struct PetStatus {
+		PetHandle pet;
+		/* Views into the NameTable and the level names, copying a status never allocates*/
+		std::string_view name;
+		std::string_view level;
+		int hunger = 0;
+		/* World position at the last motion tick, e.g. for the camera to follow*/
+		glm::vec2 position = glm::vec2(0.f);
+	};
+
+	/* Immutable view of the simulation at a point in time*/
+	struct RenderSnapshot {
+		int tick = 0;
+		double simTime = 0.0;
+		/* Motion accumulator left over when the snapshot was published*/
+		float motionRemainder = 0.f;
+		float motionTickDuration = 1.f;
+		/* Pets inside the view, see Simulation::setViewRect*/
+		std::vector<SpriteInstance> sprites;
+		/* Pets the UI shows, currently the selected one*/
+		std::vector<PetStatus> statuses;
+		PetHandle selectedPet;
+
+		/* Null when the pet does not exist anymore*/
+		const PetStatus* FindStatus(PetHandle pet) const;
+
+		/* How far time is between the previous and the current motion tick, in [0, 1]*/
+		float getAlpha(double time) const;
+		/* True when any sprite moved during the last motion tick*/
+		bool hasMotion() const;
+	};
+
+	/*
+		Lock-free triple buffer between the simulation thread (writer) and the render thread (reader).
+		The writer always owns one slot, the reader owns another and the third one is exchanged
+		atomically, so neither side ever waits on the other.
+	*/
+	class SnapshotBuffer
+	{
+	public:
+		SnapshotBuffer();
+
+		/* Writer side*/
+		RenderSnapshot& BeginWrite() { return m_slots[m_back]; };
+		void Publish();
+
+		/* Reader side. Returns true when a newer snapshot was swapped in*/
+		bool Acquire();
+		const RenderSnapshot& Front() const { return m_slots[m_front]; };
+
+	private:
+		static const int FRESH_BIT = 4;
+		static const int INDEX_MASK = 3;
+
+		RenderSnapshot m_slots[3];
+		std::atomic<int> m_middle;
+		int m_back;
+		int m_front;
+	};
+}
@@ -0,0 +1,101 @@
+#include "RenderTarget.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+#include "stb_image_write.h"
+#include "GLState.h"
+
+namespace PetGame {
+	RenderTarget::RenderTarget(int width, int height)
+		: m_width(width),
+		m_height(height),
+		m_fbo(0),
+		m_colorTexture(0),
+		m_complete(false)
+	{
+		glGenTextures(1, &m_colorTexture);
+		GLState::BindTexture(GL_TEXTURE_2D, m_colorTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glGenFramebuffers(1, &m_fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+		m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		if (!m_complete) {
+			std::cout << "Render target " << m_width << "x" << m_height << " is incomplete" << std::endl;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	RenderTarget::~RenderTarget()
+	{
+		glDeleteFramebuffers(1, &m_fbo);
+		GLState::ForgetTexture(m_colorTexture);
+		glDeleteTextures(1, &m_colorTexture);
+	}
+
+	void RenderTarget::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		glViewport(0, 0, m_width, m_height);
+	}
+
+	void RenderTarget::BindDefault(int width, int height)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, width, height);
+	}
+
+	bool RenderTarget::Capture(const std::string& filePath) const
+	{
+		std::vector<unsigned char> pixels((size_t)m_width * m_height * 4);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+		// GL rows start at the bottom, PNG rows at the top
+		stbi_flip_vertically_on_write(1);
+		if (!stbi_write_png(filePath.c_str(), m_width, m_height, 4, pixels.data(), m_width * 4)) {
+			std::cout << "Failed to write " << filePath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void RenderTarget::BlitToScreen(int screenWidth, int screenHeight) const
+	{
+		int x, y, width, height;
+		getBlitRect(screenWidth, screenHeight, x, y, width, height);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, m_width, m_height, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void RenderTarget::getBlitRect(int screenWidth, int screenHeight, int& x, int& y, int& width, int& height) const
+	{
+		int scaleX = screenWidth / m_width;
+		int scaleY = screenHeight / m_height;
+		int scale = (scaleX < scaleY) ? scaleX : scaleY;
+
+		if (scale >= 1) {
+			width = m_width * scale;
+			height = m_height * scale;
+		}
+		else {
+			// Window smaller than the target, shrink to fit and accept uneven pixels
+			float fit = ((float)screenWidth / m_width < (float)screenHeight / m_height)
+				? (float)screenWidth / m_width : (float)screenHeight / m_height;
+			width = (int)(m_width * fit);
+			height = (int)(m_height * fit);
+		}
+		x = (screenWidth - width) / 2;
+		y = (screenHeight - height) / 2;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+
+namespace PetGame {
+	/*
+		Offscreen framebuffer with a single RGBA8 color texture, sampled with GL_NEAREST so pixel
+		art stays crisp when the result is scaled up to the window.
+	*/
+	class RenderTarget
+	{
+	public:
+		RenderTarget(int width, int height);
+		~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+
+		/* Makes this the draw framebuffer and sets the viewport to cover it*/
+		void Bind() const;
+		static void BindDefault(int width, int height);
+
+		/* Copies into the default framebuffer at the largest integer scale that fits, centered*/
+		void BlitToScreen(int screenWidth, int screenHeight) const;
+		/* Where BlitToScreen puts the image, in pixels from the bottom left of the screen*/
+		void getBlitRect(int screenWidth, int screenHeight, int& x, int& y, int& width, int& height) const;
+
+		/* Reads the color buffer back and writes it as a PNG. Stalls until the GPU finished drawing*/
+		bool Capture(const std::string& filePath) const;
+
+		bool isComplete() const { return m_complete; };
+		int getWidth() const { return m_width; };
+		int getHeight() const { return m_height; };
+		unsigned int getTexture() const { return m_colorTexture; };
+
+	private:
+		int m_width;
+		int m_height;
+		unsigned int m_fbo;
+		unsigned int m_colorTexture;
+		bool m_complete;
+	};
+}
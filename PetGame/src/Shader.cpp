@@ -1,5 +1,8 @@
 #include "Shader.h"
 #include "stb_image.h"
+#include "GLState.h"
+#include "FrameUniforms.h"
+#include "ShaderCache.h"
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	std::string vertexSource;
@@ -30,39 +33,135 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 		if (fShaderFile.fail()) std::cerr << "   Fragment shader file failed to open\n";
 	}
 
-	const char* vShaderCode = vertexSource.c_str();
-	const char* fShaderCode = fragSource.c_str();
+	create(vertexSource, fragSource);
+}
+
+Shader::Shader()
+	: ID(0)
+{
+}
+
+Shader Shader::FromSource(const std::string& vertexSource, const std::string& fragSource)
+{
+	Shader shader;
+	shader.create(vertexSource, fragSource);
+	return shader;
+}
+
+bool Shader::ReadSource(const char* path, std::string& source)
+{
+	std::ifstream file(path);
+	if (!file) {
+		std::cerr << "ERROR::SHADER::FILE_NOT_READ: " << path << std::endl;
+		return false;
+	}
+	std::stringstream stream;
+	stream << file.rdbuf();
+	source = stream.str();
+	return true;
+}
 
+void Shader::create(const std::string& vertexSource, const std::string& fragSource)
+{
 	ID = glCreateProgram();
-	unsigned int vertexID, fragmentID;
+	if (!PetGame::ShaderCache::Load(ID, vertexSource, fragSource)) {
+		unsigned int vertexID = compileStage(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+		unsigned int fragmentID = compileStage(GL_FRAGMENT_SHADER, fragSource, "FRAGMENT");
+		if (linkStages(ID, vertexID, fragmentID)) {
+			PetGame::ShaderCache::Store(ID, vertexSource, fragSource);
+		}
+		glDeleteShader(vertexID);
+		glDeleteShader(fragmentID);
+	}
+	bindUniformBlocks();
+}
 
-	vertexID = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexID, 1, &vShaderCode, NULL);
-	glCompileShader(vertexID);
-	glAttachShader(ID, vertexID);
-	checkShaderCompilation(vertexID, "VERTEX");
+bool Shader::Reload(const std::string& vertexSource, const std::string& fragSource)
+{
+	unsigned int vertexID = compileStage(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+	unsigned int fragmentID = compileStage(GL_FRAGMENT_SHADER, fragSource, "FRAGMENT");
 
-	fragmentID = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentID, 1, &fShaderCode, NULL);
-	glCompileShader(fragmentID);
-	glAttachShader(ID, fragmentID);
-	checkShaderCompilation(fragmentID, "FRAGMENT");
+	// Try the stages on a scratch program first so a broken edit never leaves ID unlinked
+	unsigned int scratch = glCreateProgram();
+	bool linked = linkStages(scratch, vertexID, fragmentID);
+	glDeleteProgram(scratch);
 
-	glLinkProgram(ID);
-	checkShaderProgramLinking();
+	// Relinking in place keeps the name, uniforms go back to their defaults
+	if (linked) {
+		linked = linkStages(ID, vertexID, fragmentID);
+	}
+	if (linked) {
+		PetGame::ShaderCache::Store(ID, vertexSource, fragSource);
+		bindUniformBlocks();
+	}
 
 	glDeleteShader(vertexID);
 	glDeleteShader(fragmentID);
+	return linked;
+}
+
+unsigned int Shader::compileStage(unsigned int type, const std::string& source, const char* shaderName) const
+{
+	const char* code = source.c_str();
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &code, NULL);
+	glCompileShader(shader);
+	checkShaderCompilation(shader, shaderName);
+	return shader;
+}
+
+bool Shader::linkStages(unsigned int program, unsigned int vertexID, unsigned int fragmentID) const
+{
+	glAttachShader(program, vertexID);
+	glAttachShader(program, fragmentID);
+	PetGame::ShaderCache::PrepareProgram(program);
+	glLinkProgram(program);
+	bool linked = checkShaderProgramLinking(program);
+	glDetachShader(program, vertexID);
+	glDetachShader(program, fragmentID);
+	return linked;
+}
+
+void Shader::bindUniformBlocks()
+{
+	// Programs that use the per frame block all read it from the same binding point
+	unsigned int frameBlock = glGetUniformBlockIndex(ID, PetGame::FRAME_DATA_BLOCK);
+	if (frameBlock != GL_INVALID_INDEX) {
+		glUniformBlockBinding(ID, frameBlock, PetGame::FRAME_DATA_BINDING);
+	}
 }
 
 Shader::~Shader()
 {
+	if (ID == 0) {
+		return;
+	}
 	std::cout << "Deleting Shader program" << std::endl;
+	PetGame::GLState::ForgetProgram(ID);
 	glDeleteProgram(ID);
 }
 
+Shader::Shader(Shader&& other) noexcept
+	: ID(other.ID)
+{
+	other.ID = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+	if (this != &other) {
+		if (ID != 0) {
+			PetGame::GLState::ForgetProgram(ID);
+			glDeleteProgram(ID);
+		}
+		ID = other.ID;
+		other.ID = 0;
+	}
+	return *this;
+}
+
 void Shader::use() {
-	glUseProgram(ID);
+	PetGame::GLState::UseProgram(ID);
 }
 
 void Shader::setBool(const std::string& name, bool value) const {
@@ -87,7 +186,7 @@ void Shader::setVec3(const std::string& name, const glm::vec3& vec3)
 	glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec3));
 }
 
-void Shader::checkShaderCompilation(unsigned int shader, const char* shaderName = "SHADER") const {
+bool Shader::checkShaderCompilation(unsigned int shader, const char* shaderName = "SHADER") const {
 	int  success;
 	char infoLog[512];
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
@@ -100,20 +199,22 @@ void Shader::checkShaderCompilation(unsigned int shader, const char* shaderName
 	else {
 		std::cout << "SUCCESS::SHADER::" << shaderName << "::COMPILATION_DONE\n" << std::endl;
 	}
+	return success;
 }
 
-void Shader::checkShaderProgramLinking() const {
+bool Shader::checkShaderProgramLinking(unsigned int program) const {
 	int  success;
 	char infoLog[512];
-	glGetProgramiv(ID, 0x8B81, &success);
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
 
 	if (!success)
 	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER_PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 	}
 	else {
 		std::cout << "SUCCESS::SHADER_PROGRAM::LINKING_DONE\n" << std::endl;
 	}
+	return success;
 }
 
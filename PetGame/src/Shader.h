@@ -15,6 +15,16 @@ public:
 
 	Shader(const char* vertexPath, const char* fragmentPath);
 	~Shader();
+
+	static Shader FromSource(const std::string& vertexSource, const std::string& fragSource);
+	static bool ReadSource(const char* path, std::string& source);
+
+	// A Shader owns its program, it can be moved but never copied
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void use();
 	void setBool(const std::string& name, bool value) const;
 	void setInt(const std::string& name, int value) const;
@@ -22,7 +32,16 @@ public:
 	void setMat4(const std::string& name, const glm::mat4& mat);
 	void setVec3(const std::string& name, const glm::vec3& vec3);
 
+	/* Relinks the same program name with new sources. On a compile or link error the current program is kept*/
+	bool Reload(const std::string& vertexSource, const std::string& fragSource);
+
 private:
-	void checkShaderCompilation(unsigned int shader, const char* shaderName) const;
-	void checkShaderProgramLinking() const;
+	Shader();
+
+	bool checkShaderCompilation(unsigned int shader, const char* shaderName) const;
+	bool checkShaderProgramLinking(unsigned int program) const;
+	void create(const std::string& vertexSource, const std::string& fragSource);
+	unsigned int compileStage(unsigned int type, const std::string& source, const char* shaderName) const;
+	bool linkStages(unsigned int program, unsigned int vertexID, unsigned int fragmentID) const;
+	void bindUniformBlocks();
 };
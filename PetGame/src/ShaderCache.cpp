@@ -0,0 +1,144 @@
+#include "ShaderCache.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "Profiler.h"
+
+// Not part of the GL 3.3 glad profile, loaded by hand
+#define PETGAME_GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define PETGAME_GL_PROGRAM_BINARY_LENGTH 0x8741
+#define PETGAME_GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+typedef void (APIENTRYP PFN_GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFN_ProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFN_ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+namespace PetGame {
+	static ProfilerCounter s_cacheHits("Shader/Binary cache hits");
+	static ProfilerCounter s_cacheMisses("Shader/Binary cache misses");
+
+	static PFN_GetProgramBinary s_getProgramBinary = nullptr;
+	static PFN_ProgramBinary s_programBinary = nullptr;
+	static PFN_ProgramParameteri s_programParameteri = nullptr;
+
+	static const uint32_t CACHE_MAGIC = 0x50474253; // "PGBS"
+
+	bool ShaderCache::s_enabled = false;
+	std::string ShaderCache::s_directory;
+	std::string ShaderCache::s_driver;
+
+	static uint64_t HashFnv1a(const std::string& data, uint64_t hash = 14695981039346656037ull)
+	{
+		for (unsigned char c : data) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool ShaderCache::Init(GLADloadproc load, const char* directory)
+	{
+		s_enabled = false;
+		s_getProgramBinary = (PFN_GetProgramBinary)load("glGetProgramBinary");
+		s_programBinary = (PFN_ProgramBinary)load("glProgramBinary");
+		s_programParameteri = (PFN_ProgramParameteri)load("glProgramParameteri");
+		if (!s_getProgramBinary || !s_programBinary || !s_programParameteri) {
+			std::cout << "Shader cache disabled, program binaries not supported" << std::endl;
+			return false;
+		}
+
+		GLint formats = 0;
+		glGetIntegerv(PETGAME_GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		if (glGetError() != GL_NO_ERROR || formats <= 0) {
+			std::cout << "Shader cache disabled, driver has no program binary formats" << std::endl;
+			return false;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			std::cout << "Shader cache disabled, cannot create " << directory << std::endl;
+			return false;
+		}
+
+		s_directory = directory;
+		s_driver = std::string((const char*)glGetString(GL_VENDOR)) + "|"
+			+ (const char*)glGetString(GL_RENDERER) + "|"
+			+ (const char*)glGetString(GL_VERSION);
+		s_enabled = true;
+		return true;
+	}
+
+	std::string ShaderCache::getEntryPath(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		uint64_t hash = HashFnv1a(s_driver);
+		hash = HashFnv1a(vertexSource, hash);
+		hash = HashFnv1a("|", hash);
+		hash = HashFnv1a(fragmentSource, hash);
+
+		std::stringstream path;
+		path << s_directory << "/" << std::hex << hash << ".bin";
+		return path.str();
+	}
+
+	bool ShaderCache::Load(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		if (!s_enabled) {
+			return false;
+		}
+
+		std::ifstream file(getEntryPath(vertexSource, fragmentSource), std::ios::binary);
+		uint32_t magic = 0;
+		GLenum format = 0;
+		if (!file || !file.read((char*)&magic, sizeof(magic)) || !file.read((char*)&format, sizeof(format)) || magic != CACHE_MAGIC) {
+			s_cacheMisses.Add();
+			return false;
+		}
+		std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		s_programBinary(program, format, binary.data(), (GLsizei)binary.size());
+		GLint linked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			// Rejected by the driver, the caller compiles from source and overwrites the entry
+			s_cacheMisses.Add();
+			return false;
+		}
+		s_cacheHits.Add();
+		return true;
+	}
+
+	void ShaderCache::PrepareProgram(unsigned int program)
+	{
+		if (s_enabled) {
+			s_programParameteri(program, PETGAME_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+	}
+
+	void ShaderCache::Store(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		if (!s_enabled) {
+			return;
+		}
+
+		GLint length = 0;
+		glGetProgramiv(program, PETGAME_GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		s_getProgramBinary(program, length, nullptr, &format, binary.data());
+
+		std::ofstream file(getEntryPath(vertexSource, fragmentSource), std::ios::binary | std::ios::trunc);
+		file.write((const char*)&CACHE_MAGIC, sizeof(CACHE_MAGIC));
+		file.write((const char*)&format, sizeof(format));
+		file.write(binary.data(), binary.size());
+		if (!file) {
+			std::cout << "Failed to write shader cache entry" << std::endl;
+		}
+	}
+}
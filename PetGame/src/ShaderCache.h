@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <glad/glad.h>
+
+namespace PetGame {
+	/*
+		On disk cache of linked program binaries (GL 4.1 / ARB_get_program_binary).
+		Entries are keyed by a hash of the shader sources and the driver vendor, renderer and
+		version strings, so a driver update or an edited shader simply misses and recompiles.
+		Everything silently turns into a miss when the driver has no binary formats.
+	*/
+	class ShaderCache
+	{
+	public:
+		/* Needs a current context, load is the same proc address loader given to glad*/
+		static bool Init(GLADloadproc load, const char* directory = "shader_cache");
+		static bool isEnabled() { return s_enabled; };
+
+		/* Tries to fill program from the cache, returns false when it has to be compiled*/
+		static bool Load(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource);
+		/* Call before linking a program that will be stored*/
+		static void PrepareProgram(unsigned int program);
+		static void Store(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource);
+
+	private:
+		static bool s_enabled;
+		static std::string s_directory;
+		static std::string s_driver;
+
+		static std::string getEntryPath(const std::string& vertexSource, const std::string& fragmentSource);
+	};
+}
@@ -0,0 +1,84 @@
+#include "ShaderRegistry.h"
+#include "AllocationCounter.h"
+
+namespace PetGame {
+	ShaderHandle ShaderRegistry::Load(const std::string& name, const char* vertexPath, const char* fragmentPath)
+	{
+		AllocationScope allocationScope(AllocationTag::Assets);
+		ShaderHandle existing = Find(name);
+		if (existing.isValid()) {
+			return existing;
+		}
+
+		std::string vertexSource, fragmentSource;
+		Shader::ReadSource(vertexPath, vertexSource);
+		Shader::ReadSource(fragmentPath, fragmentSource);
+		Shader shader = Shader::FromSource(vertexSource, fragmentSource);
+		m_entries.push_back({ name, vertexPath, fragmentPath, vertexSource, fragmentSource, std::move(shader) });
+		ShaderHandle handle;
+		handle.index = (unsigned int)(m_entries.size() - 1);
+		return handle;
+	}
+
+	ShaderHandle ShaderRegistry::Find(const std::string& name) const
+	{
+		ShaderHandle handle;
+		for (size_t i = 0; i < m_entries.size(); i++) {
+			if (m_entries[i].name == name) {
+				handle.index = (unsigned int)i;
+				break;
+			}
+		}
+		return handle;
+	}
+
+	int ShaderRegistry::ReloadSource(const std::string& filePath, const std::string& source)
+	{
+		int reloaded = 0;
+		for (Entry& entry : m_entries) {
+			bool isVertex = entry.vertexPath == filePath;
+			bool isFragment = entry.fragmentPath == filePath;
+			if (!isVertex && !isFragment) {
+				continue;
+			}
+
+			const std::string& vertexSource = isVertex ? source : entry.vertexSource;
+			const std::string& fragmentSource = isFragment ? source : entry.fragmentSource;
+			if (entry.shader.Reload(vertexSource, fragmentSource)) {
+				entry.vertexSource = vertexSource;
+				entry.fragmentSource = fragmentSource;
+				reloaded++;
+			}
+			else {
+				std::cout << "Keeping the previous " << entry.name << " program" << std::endl;
+			}
+		}
+		return reloaded;
+	}
+
+	bool ShaderRegistry::UsesFile(const std::string& filePath) const
+	{
+		for (const Entry& entry : m_entries) {
+			if (entry.vertexPath == filePath || entry.fragmentPath == filePath) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Shader* ShaderRegistry::Get(ShaderHandle handle)
+	{
+		if (handle.index >= m_entries.size()) {
+			return nullptr;
+		}
+		return &m_entries[handle.index].shader;
+	}
+
+	const Shader* ShaderRegistry::Get(ShaderHandle handle) const
+	{
+		if (handle.index >= m_entries.size()) {
+			return nullptr;
+		}
+		return &m_entries[handle.index].shader;
+	}
+}
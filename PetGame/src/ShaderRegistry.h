@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+namespace PetGame {
+	/* Non-owning reference to a program in a ShaderRegistry, cheap to copy and store*/
+	struct ShaderHandle {
+		static const unsigned int INVALID = 0xFFFFFFFF;
+
+		unsigned int index = INVALID;
+
+		bool isValid() const { return index != INVALID; };
+		bool operator==(const ShaderHandle& other) const { return index == other.index; };
+		bool operator!=(const ShaderHandle& other) const { return index != other.index; };
+	};
+
+	/*
+		Sole owner of every GL program. Everything else keeps ShaderHandles and resolves them
+		with Get when drawing, so programs are never copied or deleted twice.
+		Pointers returned by Get are only valid until the next Load.
+	*/
+	class ShaderRegistry
+	{
+	public:
+		ShaderRegistry() = default;
+		~ShaderRegistry() = default;
+
+		ShaderRegistry(const ShaderRegistry&) = delete;
+		ShaderRegistry& operator=(const ShaderRegistry&) = delete;
+
+		/* Compiles the program the first time a name is seen, later calls return the same handle*/
+		ShaderHandle Load(const std::string& name, const char* vertexPath, const char* fragmentPath);
+		ShaderHandle Find(const std::string& name) const;
+
+		Shader* Get(ShaderHandle handle);
+		const Shader* Get(ShaderHandle handle) const;
+
+		/* Relinks every program built from filePath with the new source, returns how many were relinked*/
+		int ReloadSource(const std::string& filePath, const std::string& source);
+		bool UsesFile(const std::string& filePath) const;
+
+		void Clear() { m_entries.clear(); };
+
+	private:
+		struct Entry {
+			std::string name;
+			std::string vertexPath;
+			std::string fragmentPath;
+			/* Last sources that linked, so a reload of one stage can be paired with the other*/
+			std::string vertexSource;
+			std::string fragmentSource;
+			Shader shader;
+		};
+
+		std::vector<Entry> m_entries;
+	};
+}
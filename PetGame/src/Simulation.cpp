@@ -0,0 +1,302 @@
+#include "Simulation.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include "Profiler.h"
+#include "AllocationCounter.h"
+
+namespace PetGame {
+	static ProfilerCounter s_ticksRun("Sim/Ticks run");
+	static ProfilerCounter s_ticksCoalesced("Sim/Ticks coalesced");
+	static ProfilerCounter s_ticksDropped("Sim/Ticks dropped");
+	static ProfilerCounter s_tickBacklog("Sim/Tick backlog", ProfilerCounter::Kind::Gauge);
+
+	bool CommandQueue::Push(const QueuedCommand& command)
+	{
+		unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY) {
+			return false;
+		}
+		m_commands[head % CAPACITY] = command;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool CommandQueue::Pop(QueuedCommand& command)
+	{
+		unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire)) {
+			return false;
+		}
+		command = m_commands[tail % CAPACITY];
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	Simulation::Simulation(float fixedTickDuration, float motionTickDuration)
+		: m_tickCount(0),
+		m_fixedTickDuration(fixedTickDuration),
+		m_motionTickDuration(motionTickDuration),
+		m_timeAccumulator(0),
+		m_motionAccumulator(0),
+		m_maxTicksPerStep(5),
+		m_maxAccumulatedTime(2.f),
+		m_batchExcessTicks(false),
+		m_wakeOnPublish(false),
+		m_hasView(false),
+		m_viewChanged(false),
+		m_viewMin(0.f),
+		m_viewMax(0.f),
+		m_running(false)
+	{
+	}
+
+	Simulation::~Simulation()
+	{
+		Stop();
+	}
+
+	void Simulation::setTickBudget(int maxTicksPerStep, float maxAccumulatedTime, bool batchExcessTicks)
+	{
+		m_maxTicksPerStep = (maxTicksPerStep < 1) ? 1 : maxTicksPerStep;
+		m_maxAccumulatedTime = (maxAccumulatedTime < m_fixedTickDuration) ? m_fixedTickDuration : maxAccumulatedTime;
+		m_batchExcessTicks = batchExcessTicks;
+	}
+
+	void Simulation::Start()
+	{
+		if (m_running.exchange(true)) {
+			return;
+		}
+		// First snapshot before the thread exists so the renderer has something to draw
+		{
+			AllocationScope allocationScope(AllocationTag::Sim);
+			ProcessCommands();
+			Publish(glfwGetTime());
+		}
+		m_thread = std::thread(&Simulation::Run, this);
+	}
+
+	void Simulation::Stop()
+	{
+		m_running.store(false, std::memory_order_release);
+		if (m_thread.joinable()) {
+			m_thread.join();
+		}
+	}
+
+	void Simulation::setViewRect(glm::vec2 min, glm::vec2 max)
+	{
+		std::lock_guard<std::mutex> lock(m_viewMutex);
+		m_hasView = true;
+		m_viewMin = min;
+		m_viewMax = max;
+		m_viewChanged.store(true, std::memory_order_release);
+	}
+
+	void Simulation::Run()
+	{
+		AllocationScope allocationScope(AllocationTag::Sim);
+		double previousTime = glfwGetTime();
+		while (m_running.load(std::memory_order_acquire)) {
+			double currentTime = glfwGetTime();
+			float deltaTime = (float)(currentTime - previousTime);
+			previousTime = currentTime;
+
+			bool changed = ProcessCommands();
+			changed |= m_viewChanged.exchange(false, std::memory_order_acq_rel);
+
+			m_timeAccumulator += deltaTime;
+			changed |= RunTicks() > 0;
+			m_motionAccumulator += deltaTime;
+			changed |= RunMotionTicks();
+
+			// Nothing new to draw when the pets stood still, the renderer keeps its last snapshot
+			if (changed) {
+				Publish(currentTime);
+			}
+
+			// Sleep until whichever tick comes first, the renderer interpolates in between
+			float untilTick = m_fixedTickDuration - m_timeAccumulator;
+			float untilMotion = m_motionTickDuration - m_motionAccumulator;
+			double wakeTime = currentTime + ((untilTick < untilMotion) ? untilTick : untilMotion);
+			double remaining = wakeTime - glfwGetTime();
+			if (remaining > 0.0) {
+				std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+			}
+		}
+	}
+
+	bool Simulation::ProcessCommands()
+	{
+		bool processed = false;
+		QueuedCommand command;
+		while (m_commands.Pop(command)) {
+			if (command.command == PetCommand::Pick) {
+				uint32_t slot;
+				if (m_world.getGrid().Pick(command.position, slot)) {
+					m_selectedPet = m_world.getHandleOfSlot(slot);
+					processed = true;
+				}
+				continue;
+			}
+
+			// Commands for pets that were destroyed in the meantime are dropped
+			DigiPet::Pet* pet = m_world.Get(command.pet);
+			if (!pet) {
+				continue;
+			}
+			processed = true;
+			switch (command.command) {
+			case PetCommand::Feed:
+				pet->feed(m_tickCount);
+				break;
+			case PetCommand::Hurt:
+				pet->hurt(m_tickCount);
+				break;
+			case PetCommand::DisplayStatus:
+				pet->displayStatus();
+				break;
+			case PetCommand::Select:
+				m_selectedPet = command.pet;
+				break;
+			default:
+				break;
+			}
+		}
+		return processed;
+	}
+
+	int Simulation::RunTicks()
+	{
+		if (m_timeAccumulator > m_maxAccumulatedTime) {
+			int dropped = (int)((m_timeAccumulator - m_maxAccumulatedTime) / m_fixedTickDuration);
+			s_ticksDropped.Add(dropped);
+			std::cout << "Simulation fell behind, dropping " << dropped << " ticks" << std::endl;
+			m_timeAccumulator = m_maxAccumulatedTime;
+		}
+
+		int pendingTicks = (int)(m_timeAccumulator / m_fixedTickDuration);
+		int budgetTicks = (pendingTicks < m_maxTicksPerStep) ? pendingTicks : m_maxTicksPerStep;
+		for (int i = 0; i < budgetTicks; i++) {
+			FixedUpdate();
+			m_timeAccumulator -= m_fixedTickDuration;
+		}
+
+		int excessTicks = pendingTicks - budgetTicks;
+		if (excessTicks > 0 && m_batchExcessTicks) {
+			AdvanceTicks(excessTicks);
+			m_timeAccumulator -= excessTicks * m_fixedTickDuration;
+			excessTicks = 0;
+		}
+		// Without batching the excess stays in the accumulator for the next steps
+		s_tickBacklog.Set(excessTicks);
+		return pendingTicks - excessTicks;
+	}
+
+	void Simulation::FixedUpdate()
+	{
+		for (size_t i = 0; i < m_world.getCount(); i++) {
+			m_world.getPet(i).UpdateTick(m_fixedTickDuration, m_tickCount);
+		}
+		// After the states, so a state entered or left this tick already set its rates
+		m_world.TickVitals(m_tickCount);
+		m_tickCount++;
+		s_ticksRun.Add();
+	}
+
+	bool Simulation::RunMotionTicks()
+	{
+		// Motion is cosmetic, so a backlog is simply skipped instead of replayed
+		int pendingTicks = (int)(m_motionAccumulator / m_motionTickDuration);
+		if (pendingTicks > m_maxTicksPerStep) {
+			m_motionAccumulator -= (pendingTicks - m_maxTicksPerStep) * m_motionTickDuration;
+			pendingTicks = m_maxTicksPerStep;
+		}
+		bool moved = false;
+		for (int i = 0; i < pendingTicks; i++) {
+			for (size_t p = 0; p < m_world.getCount(); p++) {
+				DigiPet::Pet& pet = m_world.getPet(p);
+				pet.UpdateMotion(m_motionTickDuration);
+				m_world.UpdatePosition(p);
+				moved |= pet.getPosition() != pet.getPreviousPosition() || pet.getRotation() != pet.getPreviousRotation();
+			}
+			m_motionAccumulator -= m_motionTickDuration;
+		}
+		return moved;
+	}
+
+	void Simulation::AdvanceTicks(int ticks)
+	{
+		for (size_t i = 0; i < m_world.getCount(); i++) {
+			m_world.getPet(i).AdvanceTicks(m_fixedTickDuration, m_tickCount, ticks);
+		}
+		// The states ran ahead, so the vitals see the rates they ended the backlog with
+		for (int i = 0; i < ticks; i++) {
+			m_world.TickVitals(m_tickCount + i);
+		}
+		m_tickCount += ticks;
+		s_ticksCoalesced.Add(ticks);
+	}
+
+	void Simulation::Publish(double simTime)
+	{
+		RenderSnapshot& snapshot = m_snapshots.BeginWrite();
+		snapshot.tick = m_tickCount;
+		snapshot.simTime = simTime;
+		snapshot.motionRemainder = m_motionAccumulator;
+		snapshot.motionTickDuration = m_motionTickDuration;
+
+		// Only what the view can show is copied, the cost follows the screen and not the world
+		m_visible.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_viewMutex);
+			if (m_hasView) {
+				m_world.getGrid().QueryRect(m_viewMin, m_viewMax, m_visible);
+			}
+			else {
+				for (size_t i = 0; i < m_world.getCount(); i++) {
+					m_visible.push_back(m_world.getHandle(i).index);
+				}
+			}
+		}
+		// Grid order is arbitrary, slots give overlapping pets a stable draw order
+		std::sort(m_visible.begin(), m_visible.end());
+
+		// The vectors keep their capacity between publishes, so a stable world allocates nothing
+		snapshot.sprites.resize(m_visible.size());
+		for (size_t i = 0; i < m_visible.size(); i++) {
+			PetHandle handle = m_world.getHandleOfSlot(m_visible[i]);
+			const DigiPet::Pet& pet = *m_world.Get(handle);
+
+			SpriteInstance& sprite = snapshot.sprites[i];
+			sprite.pet = handle;
+			sprite.texture = pet.getTexture();
+			sprite.animation = pet.getAnimation();
+			sprite.position = pet.getPosition();
+			sprite.previousPosition = pet.getPreviousPosition();
+			sprite.size = pet.getSize();
+			sprite.rotation = pet.getRotation();
+			sprite.previousRotation = pet.getPreviousRotation();
+			sprite.color = pet.getColorTint();
+		}
+
+		snapshot.selectedPet = m_selectedPet;
+		snapshot.statuses.clear();
+		const DigiPet::Pet* selected = m_world.Get(m_selectedPet);
+		if (selected) {
+			PetStatus status;
+			status.pet = m_selectedPet;
+			status.name = selected->getName();
+			status.level = selected->getLevel();
+			status.hunger = selected->getHunger();
+			status.position = selected->getPosition();
+			snapshot.statuses.push_back(status);
+		}
+
+		m_snapshots.Publish();
+		if (m_wakeOnPublish) {
+			glfwPostEmptyEvent();
+		}
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include "DigiPet.h"
+#include "PetWorld.h"
+#include "RenderSnapshot.h"
+
+namespace PetGame {
+	enum class PetCommand {
+		Feed,
+		Hurt,
+		DisplayStatus,
+		/* Selects the given pet*/
+		Select,
+		/* Selects the pet under position, in world coordinates*/
+		Pick,
+	};
+
+	/* A command and the pet or the point it is addressed to*/
+	struct QueuedCommand {
+		PetCommand command;
+		PetHandle pet;
+		glm::vec2 position;
+	};
+
+	/* Single producer / single consumer ring used to send input to the simulation thread*/
+	class CommandQueue
+	{
+	public:
+		CommandQueue() : m_head(0), m_tail(0) {};
+
+		bool Push(const QueuedCommand& command);
+		bool Pop(QueuedCommand& command);
+
+	private:
+		static const unsigned int CAPACITY = 64;
+
+		QueuedCommand m_commands[CAPACITY];
+		std::atomic<unsigned int> m_head;
+		std::atomic<unsigned int> m_tail;
+	};
+
+	/*
+		Runs the fixed tick simulation on its own thread and publishes a RenderSnapshot
+		after every step. The render thread never touches the pets directly, it addresses them
+		by PetHandle through commands and reads them back from the snapshots.
+	*/
+	class Simulation
+	{
+	public:
+		/* Game logic runs every fixedTickDuration, pet motion every motionTickDuration*/
+		Simulation(float fixedTickDuration, float motionTickDuration = 1.f / 10.f);
+		~Simulation();
+
+		void Start();
+		void Stop();
+
+		/*
+			Bounds the catch-up work after a stall. At most maxTicksPerStep ticks run per step and
+			anything past maxAccumulatedTime is dropped. With batchExcessTicks the remaining backlog
+			is advanced in one coalesced call instead of being spread over the next steps.
+			Must be called before Start.
+		*/
+		void setTickBudget(int maxTicksPerStep, float maxAccumulatedTime, bool batchExcessTicks);
+
+		/* Posts an empty GLFW event after every publish so a render loop blocked in glfwWaitEvents wakes up*/
+		void setWakeOnPublish(bool enabled) { m_wakeOnPublish = enabled; };
+
+		void PushCommand(PetCommand command, PetHandle pet) { m_commands.Push({ command, pet, glm::vec2(0.f) }); };
+		void PushPick(glm::vec2 worldPosition) { m_commands.Push({ PetCommand::Pick, PetHandle(), worldPosition }); };
+		/*
+			Only pets overlapping this world rectangle are published for drawing. A new rect is published
+			on the next step even when nothing moved. Callable from any thread
+		*/
+		void setViewRect(glm::vec2 min, glm::vec2 max);
+		SnapshotBuffer& getSnapshots() { return m_snapshots; };
+		/* Only safe to use before Start or after Stop*/
+		PetWorld& getWorld() { return m_world; };
+
+	private:
+		PetWorld m_world;
+
+		int m_tickCount;
+		float m_fixedTickDuration;
+		float m_motionTickDuration;
+		float m_timeAccumulator;
+		float m_motionAccumulator;
+
+		int m_maxTicksPerStep;
+		float m_maxAccumulatedTime;
+		bool m_batchExcessTicks;
+		bool m_wakeOnPublish;
+
+		CommandQueue m_commands;
+		SnapshotBuffer m_snapshots;
+		PetHandle m_selectedPet;
+
+		std::mutex m_viewMutex;
+		bool m_hasView;
+		std::atomic<bool> m_viewChanged;
+		glm::vec2 m_viewMin;
+		glm::vec2 m_viewMax;
+		/* Grid query results, kept to reuse the allocation*/
+		std::vector<uint32_t> m_visible;
+
+		std::thread m_thread;
+		std::atomic<bool> m_running;
+
+		void Run();
+		bool ProcessCommands();
+		int RunTicks();
+		void FixedUpdate();
+		bool RunMotionTicks();
+		void AdvanceTicks(int ticks);
+		void Publish(double simTime);
+	};
+}
@@ -0,0 +1,167 @@
+#include "SpatialGrid.h"
+#include <cmath>
+
+namespace PetGame {
+	SpatialGrid::SpatialGrid(float cellSize)
+		: m_cellSize(cellSize),
+		m_maxHalfExtent(0.f)
+	{
+	}
+
+	int SpatialGrid::CellCoord(float value) const
+	{
+		return (int)std::floor(value / m_cellSize);
+	}
+
+	void SpatialGrid::Insert(uint32_t id, glm::vec2 center, glm::vec2 halfExtent)
+	{
+		if (id >= m_items.size()) {
+			m_items.resize(id + 1, Item{ glm::vec2(0.f), glm::vec2(0.f), 0, 0, false });
+		}
+		m_maxHalfExtent = glm::max(m_maxHalfExtent, halfExtent);
+
+		Item& item = m_items[id];
+		item.halfExtent = halfExtent;
+		if (item.inserted) {
+			Move(id, center);
+			return;
+		}
+		item.center = center;
+		item.inserted = true;
+		AddToCell(id, CellKey(CellCoord(center.x), CellCoord(center.y)));
+	}
+
+	void SpatialGrid::Move(uint32_t id, glm::vec2 center)
+	{
+		if (id >= m_items.size() || !m_items[id].inserted) {
+			return;
+		}
+		Item& item = m_items[id];
+		item.center = center;
+		int64_t cell = CellKey(CellCoord(center.x), CellCoord(center.y));
+		if (cell != item.cell) {
+			RemoveFromCell(id);
+			AddToCell(id, cell);
+		}
+	}
+
+	void SpatialGrid::Remove(uint32_t id)
+	{
+		if (id >= m_items.size() || !m_items[id].inserted) {
+			return;
+		}
+		RemoveFromCell(id);
+		m_items[id].inserted = false;
+	}
+
+	void SpatialGrid::Clear()
+	{
+		m_items.clear();
+		m_cells.clear();
+		m_maxHalfExtent = glm::vec2(0.f);
+	}
+
+	void SpatialGrid::AddToCell(uint32_t id, int64_t cell)
+	{
+		std::vector<uint32_t>& ids = m_cells[cell];
+		m_items[id].cell = cell;
+		m_items[id].slot = (uint32_t)ids.size();
+		ids.push_back(id);
+	}
+
+	void SpatialGrid::RemoveFromCell(uint32_t id)
+	{
+		Item& item = m_items[id];
+		auto cell = m_cells.find(item.cell);
+		std::vector<uint32_t>& ids = cell->second;
+		uint32_t last = ids.back();
+		ids[item.slot] = last;
+		m_items[last].slot = item.slot;
+		ids.pop_back();
+		// Drifting pets would otherwise leave a trail of empty cells behind
+		if (ids.empty()) {
+			m_cells.erase(cell);
+		}
+	}
+
+	template <typename Visit>
+	void SpatialGrid::VisitCells(glm::vec2 min, glm::vec2 max, Visit visit) const
+	{
+		min -= m_maxHalfExtent;
+		max += m_maxHalfExtent;
+		int minX = CellCoord(min.x), maxX = CellCoord(max.x);
+		int minY = CellCoord(min.y), maxY = CellCoord(max.y);
+
+		// A zoomed out view can span more cells than exist, walk the occupied ones instead
+		double spanned = ((double)maxX - minX + 1) * ((double)maxY - minY + 1);
+		if (spanned > (double)m_cells.size()) {
+			for (const auto& cell : m_cells) {
+				int x = (int)(cell.first >> 32);
+				int y = (int)(int32_t)(uint32_t)cell.first;
+				if (x >= minX && x <= maxX && y >= minY && y <= maxY) {
+					visit(cell.second);
+				}
+			}
+			return;
+		}
+
+		for (int x = minX; x <= maxX; x++) {
+			for (int y = minY; y <= maxY; y++) {
+				auto cell = m_cells.find(CellKey(x, y));
+				if (cell != m_cells.end()) {
+					visit(cell->second);
+				}
+			}
+		}
+	}
+
+	void SpatialGrid::QueryRect(glm::vec2 min, glm::vec2 max, std::vector<uint32_t>& out) const
+	{
+		VisitCells(min, max, [&](const std::vector<uint32_t>& ids) {
+			for (uint32_t id : ids) {
+				const Item& item = m_items[id];
+				glm::vec2 itemMin = item.center - item.halfExtent;
+				glm::vec2 itemMax = item.center + item.halfExtent;
+				if (itemMax.x >= min.x && itemMin.x <= max.x && itemMax.y >= min.y && itemMin.y <= max.y) {
+					out.push_back(id);
+				}
+			}
+		});
+	}
+
+	void SpatialGrid::QueryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& out) const
+	{
+		// Centers are what is tested, so the box padding of VisitCells is not needed but harmless
+		float radiusSquared = radius * radius;
+		VisitCells(center - glm::vec2(radius), center + glm::vec2(radius), [&](const std::vector<uint32_t>& ids) {
+			for (uint32_t id : ids) {
+				glm::vec2 offset = m_items[id].center - center;
+				if (glm::dot(offset, offset) <= radiusSquared) {
+					out.push_back(id);
+				}
+			}
+		});
+	}
+
+	bool SpatialGrid::Pick(glm::vec2 point, uint32_t& id) const
+	{
+		bool found = false;
+		float bestDistance = 0.f;
+		VisitCells(point, point, [&](const std::vector<uint32_t>& ids) {
+			for (uint32_t candidate : ids) {
+				const Item& item = m_items[candidate];
+				glm::vec2 offset = glm::abs(point - item.center);
+				if (offset.x > item.halfExtent.x || offset.y > item.halfExtent.y) {
+					continue;
+				}
+				float distance = glm::dot(offset, offset);
+				if (!found || distance < bestDistance) {
+					found = true;
+					bestDistance = distance;
+					id = candidate;
+				}
+			}
+		});
+		return found;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "glm/glm.hpp"
+
+namespace PetGame {
+	/*
+		Uniform hash grid over axis aligned boxes, keyed by a small integer id (the PetWorld slot).
+		Only occupied cells exist, so the world can be unbounded. Moving an item only touches the
+		hash map when it crosses into another cell.
+	*/
+	class SpatialGrid
+	{
+	public:
+		explicit SpatialGrid(float cellSize = 128.f);
+
+		/* center and halfExtent describe the box, re-inserting an id moves it*/
+		void Insert(uint32_t id, glm::vec2 center, glm::vec2 halfExtent);
+		void Move(uint32_t id, glm::vec2 center);
+		void Remove(uint32_t id);
+		void Clear();
+
+		/* Ids whose box overlaps the rectangle, appended to out in no particular order*/
+		void QueryRect(glm::vec2 min, glm::vec2 max, std::vector<uint32_t>& out) const;
+		/* Ids whose center is within radius*/
+		void QueryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& out) const;
+		/* Id whose box contains point with the closest center, false when there is none*/
+		bool Pick(glm::vec2 point, uint32_t& id) const;
+
+		size_t getCellCount() const { return m_cells.size(); };
+
+	private:
+		struct Item {
+			glm::vec2 center;
+			glm::vec2 halfExtent;
+			int64_t cell;
+			/* Position inside the cell list, for O(1) removal*/
+			uint32_t slot;
+			bool inserted;
+		};
+
+		float m_cellSize;
+		/* Largest half extent ever inserted, queries grow by it since items are bucketed by center*/
+		glm::vec2 m_maxHalfExtent;
+		std::vector<Item> m_items;
+		std::unordered_map<int64_t, std::vector<uint32_t>> m_cells;
+
+		int CellCoord(float value) const;
+		static int64_t CellKey(int x, int y) { return ((int64_t)x << 32) | (uint32_t)y; };
+		void AddToCell(uint32_t id, int64_t cell);
+		void RemoveFromCell(uint32_t id);
+		template <typename Visit>
+		void VisitCells(glm::vec2 min, glm::vec2 max, Visit visit) const;
+	};
+}
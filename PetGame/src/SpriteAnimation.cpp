@@ -0,0 +1,158 @@
+#include "SpriteAnimation.h"
+#include <glad/glad.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "stb_image.h"
+#include "GLState.h"
+
+namespace PetGame {
+	// GL 3.3 only guarantees 1024 texels for the tick table
+	static const int MAX_TICKS = 1024;
+	// Like browsers, treat missing or tiny GIF delays as 100ms
+	static const int MIN_DELAY_MS = 20;
+	static const int DEFAULT_DELAY_MS = 100;
+
+	static int Gcd(int a, int b)
+	{
+		while (b != 0) {
+			int t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	SpriteAnimation::SpriteAnimation()
+		: m_frames(0),
+		m_frameTable(0),
+		m_width(0),
+		m_height(0),
+		m_frameCount(0),
+		m_tickCount(0),
+		m_tickDuration(0.f)
+	{
+		glGenTextures(1, &m_frames);
+		glGenTextures(1, &m_frameTable);
+	}
+
+	SpriteAnimation::~SpriteAnimation()
+	{
+		GLState::ForgetTexture(m_frames);
+		GLState::ForgetTexture(m_frameTable);
+		glDeleteTextures(1, &m_frames);
+		glDeleteTextures(1, &m_frameTable);
+	}
+
+	bool SpriteAnimation::Load(const char* filePath)
+	{
+		std::cout << "Loading " << filePath << std::endl;
+		std::ifstream file(filePath, std::ios::binary);
+		std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (bytes.empty()) {
+			std::cout << "Animation failed to load at path: " << filePath << std::endl;
+			return false;
+		}
+
+		int* delays = nullptr;
+		int width, height, frameCount, channels;
+		stbi_set_flip_vertically_on_load(true);
+		unsigned char* pixels = stbi_load_gif_from_memory(bytes.data(), (int)bytes.size(), &delays,
+			&width, &height, &frameCount, &channels, 4);
+		if (!pixels) {
+			std::cout << "Animation failed to decode: " << filePath << std::endl;
+			return false;
+		}
+
+		bool uploaded = Upload(width, height, frameCount, pixels, delays);
+		stbi_image_free(pixels);
+		stbi_image_free(delays);
+		return uploaded;
+	}
+
+	bool SpriteAnimation::Upload(int width, int height, int frameCount, const unsigned char* pixels, const int* delays)
+	{
+		if (frameCount <= 0) {
+			return false;
+		}
+
+		std::vector<int> frameDelays(frameCount);
+		int total = 0;
+		int tick = 0;
+		for (int i = 0; i < frameCount; i++) {
+			frameDelays[i] = (delays && delays[i] >= MIN_DELAY_MS) ? delays[i] : DEFAULT_DELAY_MS;
+			total += frameDelays[i];
+			tick = Gcd(tick, frameDelays[i]);
+		}
+		// Coarser ticks when the loop is too long for the table, frames shorter than a tick may be skipped
+		if (total / tick > MAX_TICKS) {
+			tick = (total + MAX_TICKS - 1) / MAX_TICKS;
+		}
+		int tickCount = (total + tick - 1) / tick;
+
+		std::vector<unsigned short> table(tickCount);
+		int frame = 0;
+		int frameEnd = frameDelays[0];
+		for (int i = 0; i < tickCount; i++) {
+			while (i * tick >= frameEnd && frame + 1 < frameCount) {
+				frame++;
+				frameEnd += frameDelays[frame];
+			}
+			table[i] = (unsigned short)frame;
+		}
+
+		m_width = width;
+		m_height = height;
+		m_frameCount = frameCount;
+		m_tickCount = tickCount;
+		m_tickDuration = tick / 1000.f;
+
+		// stb_image hands out all frames back to back, which is exactly the layer layout
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_frames);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, frameCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+
+		GLState::BindTexture(GL_TEXTURE_1D, m_frameTable);
+		glTexImage1D(GL_TEXTURE_1D, 0, GL_R16UI, tickCount, 0, GL_RED_INTEGER, GL_UNSIGNED_SHORT, table.data());
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAX_LEVEL, 0);
+		return true;
+	}
+
+	bool SpriteAnimation::ReadFrame(int frame, std::vector<unsigned char>& rgba) const
+	{
+		if (frame < 0 || frame >= m_frameCount) {
+			return false;
+		}
+		// GL 3.3 can only read back the whole array, keep the layer we want
+		size_t frameBytes = (size_t)m_width * m_height * 4;
+		std::vector<unsigned char> frames(frameBytes * m_frameCount);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_frames);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, frames.data());
+		rgba.assign(frames.begin() + frameBytes * frame, frames.begin() + frameBytes * (frame + 1));
+		return true;
+	}
+
+	void SpriteAnimation::Bind(unsigned int framesUnit, unsigned int tableUnit) const
+	{
+		GLState::ActiveTexture(framesUnit);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_frames);
+		GLState::ActiveTexture(tableUnit);
+		GLState::BindTexture(GL_TEXTURE_1D, m_frameTable);
+	}
+
+	std::unique_ptr<SpriteAnimation> SpriteAnimation::CreateAnimation(const char* filePath)
+	{
+		std::unique_ptr<SpriteAnimation> animation = std::make_unique<SpriteAnimation>();
+		animation->Load(filePath);
+		return animation;
+	}
+}
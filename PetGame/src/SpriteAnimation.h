@@ -0,0 +1,51 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+namespace PetGame {
+	/*
+		Animated sprite decoded once from a GIF. Frames are the layers of a 2D texture array and
+		a small integer lookup texture maps time ticks to frames, so sprite.vert picks the frame
+		from the frame time and the CPU never switches textures while the animation plays.
+	*/
+	class SpriteAnimation
+	{
+	public:
+		SpriteAnimation();
+		~SpriteAnimation();
+
+		SpriteAnimation(const SpriteAnimation&) = delete;
+		SpriteAnimation& operator=(const SpriteAnimation&) = delete;
+
+		bool Load(const char* filePath);
+		/* pixels holds frameCount RGBA images back to back, delays are in milliseconds*/
+		bool Upload(int width, int height, int frameCount, const unsigned char* pixels, const int* delays);
+
+		/* Binds the frames and the tick table on the given texture units*/
+		void Bind(unsigned int framesUnit, unsigned int tableUnit) const;
+		/* Copies one frame back from GL as RGBA8, bottom row first. Slow, meant for one time processing*/
+		bool ReadFrame(int frame, std::vector<unsigned char>& rgba) const;
+
+		int getWidth() const { return m_width; };
+		int getHeight() const { return m_height; };
+		int getFrameCount() const { return m_frameCount; };
+		/* Length of one loop in seconds*/
+		float getDuration() const { return m_tickCount * m_tickDuration; };
+		int getTickCount() const { return m_tickCount; };
+		float getTickDuration() const { return m_tickDuration; };
+
+		static std::unique_ptr<SpriteAnimation> CreateAnimation(const char* filePath);
+
+	private:
+		/* GL_TEXTURE_2D_ARRAY, one layer per frame*/
+		unsigned int m_frames;
+		/* GL_TEXTURE_1D R16UI, frame shown during each tick of the loop*/
+		unsigned int m_frameTable;
+
+		int m_width;
+		int m_height;
+		int m_frameCount;
+		int m_tickCount;
+		float m_tickDuration;
+	};
+}
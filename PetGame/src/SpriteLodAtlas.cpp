@@ -0,0 +1,125 @@
+#include "SpriteLodAtlas.h"
+#include <algorithm>
+#include <iostream>
+
+namespace PetGame {
+	SpriteLodAtlas::SpriteLodAtlas()
+		: m_texture(TexturePreset::UI),
+		m_dirty(true)
+	{
+		Clear();
+	}
+
+	void SpriteLodAtlas::Clear()
+	{
+		m_entries.clear();
+		// Find hands out pointers into the vector, it must never reallocate
+		m_entries.reserve(COLUMNS * COLUMNS);
+		m_lookup.clear();
+		m_pixels.assign((size_t)ATLAS_SIZE * ATLAS_SIZE * 4, 0);
+		m_dirty = true;
+	}
+
+	const SpriteLodAtlas::Entry* SpriteLodAtlas::Find(Texture2D* texture)
+	{
+		if (!texture) {
+			return nullptr;
+		}
+		auto found = m_lookup.find(texture);
+		if (found != m_lookup.end()) {
+			return (found->second < 0) ? nullptr : &m_entries[found->second];
+		}
+		std::vector<unsigned char> rgba;
+		if (!texture->ReadPixels(rgba)) {
+			m_lookup[texture] = -1;
+			return nullptr;
+		}
+		return Add(texture, rgba, texture->m_width, texture->m_height);
+	}
+
+	const SpriteLodAtlas::Entry* SpriteLodAtlas::Find(SpriteAnimation* animation)
+	{
+		if (!animation) {
+			return nullptr;
+		}
+		auto found = m_lookup.find(animation);
+		if (found != m_lookup.end()) {
+			return (found->second < 0) ? nullptr : &m_entries[found->second];
+		}
+		std::vector<unsigned char> rgba;
+		if (!animation->ReadFrame(0, rgba)) {
+			m_lookup[animation] = -1;
+			return nullptr;
+		}
+		return Add(animation, rgba, animation->getWidth(), animation->getHeight());
+	}
+
+	const SpriteLodAtlas::Entry* SpriteLodAtlas::Add(const void* source, const std::vector<unsigned char>& rgba, int width, int height)
+	{
+		int cell = (int)m_entries.size();
+		if (cell >= COLUMNS * COLUMNS) {
+			std::cout << "LOD atlas is full, sprite keeps full detail" << std::endl;
+			m_lookup[source] = -1;
+			return nullptr;
+		}
+
+		// Fit the image in the cell keeping its aspect, centered
+		float scale = (float)CELL_SIZE / (float)std::max(width, height);
+		int cellWidth = std::max(1, (int)(width * scale + 0.5f));
+		int cellHeight = std::max(1, (int)(height * scale + 0.5f));
+		int originX = (cell % COLUMNS) * CELL_STRIDE + 1 + (CELL_SIZE - cellWidth) / 2;
+		int originY = (cell / COLUMNS) * CELL_STRIDE + 1 + (CELL_SIZE - cellHeight) / 2;
+
+		// Box filter in premultiplied alpha, so transparent texels do not darken the edges
+		glm::vec3 colorSum(0.f);
+		float alphaSum = 0.f;
+		for (int y = 0; y < cellHeight; y++) {
+			int sourceY0 = y * height / cellHeight;
+			int sourceY1 = std::max(sourceY0 + 1, (y + 1) * height / cellHeight);
+			for (int x = 0; x < cellWidth; x++) {
+				int sourceX0 = x * width / cellWidth;
+				int sourceX1 = std::max(sourceX0 + 1, (x + 1) * width / cellWidth);
+
+				glm::vec3 color(0.f);
+				float alpha = 0.f;
+				for (int sy = sourceY0; sy < sourceY1; sy++) {
+					for (int sx = sourceX0; sx < sourceX1; sx++) {
+						const unsigned char* texel = &rgba[((size_t)sy * width + sx) * 4];
+						float texelAlpha = texel[3] / 255.f;
+						color += glm::vec3(texel[0], texel[1], texel[2]) * texelAlpha;
+						alpha += texelAlpha;
+					}
+				}
+				colorSum += color;
+				alphaSum += alpha;
+
+				int count = (sourceX1 - sourceX0) * (sourceY1 - sourceY0);
+				unsigned char* target = &m_pixels[((size_t)(originY + y) * ATLAS_SIZE + originX + x) * 4];
+				if (alpha > 0.f) {
+					target[0] = (unsigned char)(color.r / alpha + 0.5f);
+					target[1] = (unsigned char)(color.g / alpha + 0.5f);
+					target[2] = (unsigned char)(color.b / alpha + 0.5f);
+				}
+				target[3] = (unsigned char)(alpha / count * 255.f + 0.5f);
+			}
+		}
+
+		Entry entry;
+		entry.uvRect = glm::vec4((float)originX, (float)originY, (float)cellWidth, (float)cellHeight) / (float)ATLAS_SIZE;
+		entry.averageColor = (alphaSum > 0.f) ? colorSum / (alphaSum * 255.f) : glm::vec3(0.f);
+		entry.coverage = alphaSum / ((float)width * height);
+		m_entries.push_back(entry);
+		m_lookup[source] = cell;
+		m_dirty = true;
+		return &m_entries.back();
+	}
+
+	Texture2D* SpriteLodAtlas::getTexture()
+	{
+		if (m_dirty) {
+			m_texture.Upload(ATLAS_SIZE, ATLAS_SIZE, 4, m_pixels.data());
+			m_dirty = false;
+		}
+		return &m_texture;
+	}
+}
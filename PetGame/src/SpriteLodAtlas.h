@@ -0,0 +1,60 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Texture2D.h"
+#include "SpriteAnimation.h"
+
+namespace PetGame {
+	/*
+		Low detail stand-ins for sprites seen from far away. Every texture or animation gets a box
+		filtered copy of at most CELL_SIZE pixels in one shared atlas, so sprites at medium distance
+		are drawn from a single texture in a single batch, plus its average color for the far tier.
+		Entries are made the first time a sprite is looked up, which reads its pixels back from GL once.
+		Only used from the thread that owns the GL context.
+	*/
+	class SpriteLodAtlas
+	{
+	public:
+		static const int CELL_SIZE = 32;
+
+		struct Entry {
+			/* xy: bottom left, zw: size, in atlas texture coordinates*/
+			glm::vec4 uvRect;
+			/* Color of the opaque pixels, alpha weighted*/
+			glm::vec3 averageColor;
+			/* Fraction of the image that is opaque, used to size the far tier quad*/
+			float coverage;
+		};
+
+		SpriteLodAtlas();
+
+		SpriteLodAtlas(const SpriteLodAtlas&) = delete;
+		SpriteLodAtlas& operator=(const SpriteLodAtlas&) = delete;
+
+		/* Null when the atlas is full or the pixels could not be read. Animations use their first frame*/
+		const Entry* Find(Texture2D* texture);
+		const Entry* Find(SpriteAnimation* animation);
+
+		/* Uploads entries added since the last call, the returned pointer never changes*/
+		Texture2D* getTexture();
+
+		/* Drops every entry, e.g. after textures were reloaded. They are rebuilt on the next lookup*/
+		void Clear();
+
+	private:
+		static const int COLUMNS = 16;
+		/* One transparent texel around every cell keeps linear filtering from bleeding into neighbours*/
+		static const int CELL_STRIDE = CELL_SIZE + 2;
+		static const int ATLAS_SIZE = COLUMNS * CELL_STRIDE;
+
+		Texture2D m_texture;
+		std::vector<unsigned char> m_pixels;
+		std::vector<Entry> m_entries;
+		/* Index into m_entries by texture or animation, -1 for sources that failed*/
+		std::unordered_map<const void*, int> m_lookup;
+		bool m_dirty;
+
+		const Entry* Add(const void* source, const std::vector<unsigned char>& rgba, int width, int height);
+	};
+}
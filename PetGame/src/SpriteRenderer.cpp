@@ -1,43 +1,325 @@
 #include "SpriteRenderer.h"
 #include "glad/glad.h"
 #include "glm/glm.hpp"
+#include "GLState.h"
+#include "Profiler.h"
+#include "RadixSort.h"
+#include <cstring>
 #include <iostream>
 
-PetGame::SpriteRenderer::SpriteRenderer(Shader& shader)
-	:m_shader(shader)
+static PetGame::ProfilerCounter s_spritesDrawn("Render/Sprites", PetGame::ProfilerCounter::Kind::PerFrame);
+static PetGame::ProfilerCounter s_drawCalls("Render/Draw calls", PetGame::ProfilerCounter::Kind::PerFrame);
+static PetGame::ProfilerCounter s_spritesCulled("Render/Sprites culled", PetGame::ProfilerCounter::Kind::PerFrame);
+static PetGame::ProfilerCounter s_spritesMediumLod("Render/Sprites medium LOD", PetGame::ProfilerCounter::Kind::PerFrame);
+static PetGame::ProfilerCounter s_spritesFarLod("Render/Sprites far LOD", PetGame::ProfilerCounter::Kind::PerFrame);
+
+static const glm::vec4 FULL_UV_RECT(0.f, 0.f, 1.f, 1.f);
+
+PetGame::SpriteRenderer::SpriteRenderer(ShaderRegistry& shaders, ShaderHandle shader, ShaderHandle pointShader)
+	:m_shaders(shaders),
+	m_shader(shader),
+	m_pointShader(pointShader),
+	m_batchTexture(nullptr),
+	m_batchAnimation(nullptr),
+	m_cullEnabled(false),
+	m_cullMin(0.f),
+	m_cullMax(0.f),
+	m_lastMaterial(nullptr),
+	m_lastMaterialId(0),
+	m_lodSource(nullptr),
+	m_lodEntry(nullptr),
+	m_pixelsPerUnit(1.f),
+	m_mediumLodSize((float)SpriteLodAtlas::CELL_SIZE),
+	m_farLodSize(8.f)
 {
 	Init();
 }
 
 PetGame::SpriteRenderer::~SpriteRenderer()
 {
+	GLState::ForgetVertexArray(m_quadVAO);
 	glDeleteVertexArrays(1, &m_quadVAO);
+	GLState::ForgetVertexArray(m_pointVAO);
+	glDeleteVertexArrays(1, &m_pointVAO);
+}
+
+void PetGame::SpriteRenderer::Begin()
+{
+	m_instances.clear();
+	m_points.clear();
+	m_quadCommands.clear();
+	m_pointCommands.clear();
+	m_transforms.Clear();
+	m_keys.clear();
+	// The atlas may have been cleared since, its entries with it
+	m_lodSource = nullptr;
+	m_lodEntry = nullptr;
+	m_batchTexture = nullptr;
+	m_batchAnimation = nullptr;
+
+	// Set every frame since relinking a program, e.g. on hot reload, resets its samplers to unit 0
+	Shader* shader = m_shaders.Get(m_shader);
+	if (shader) {
+		shader->use();
+		shader->setInt("spriteTexture", TEXTURE_UNIT);
+		shader->setInt("spriteFrames", FRAMES_UNIT);
+		shader->setInt("frameTable", FRAME_TABLE_UNIT);
+	}
+}
+
+void PetGame::SpriteRenderer::setCullRect(glm::vec2 min, glm::vec2 max)
+{
+	m_cullEnabled = true;
+	m_cullMin = min;
+	m_cullMax = max;
 }
 
-void PetGame::SpriteRenderer::DrawSprite(Texture2D* texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+void PetGame::SpriteRenderer::setLodSizes(float mediumSize, float farSize)
 {
-	m_shader.use();
+	m_mediumLodSize = mediumSize;
+	m_farLodSize = farSize;
+}
 
-	glm::mat4 model = glm::mat4(1.0f);
-	model = glm::translate(model, glm::vec3(position, 0.0f));
-	model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.f, 0.f, 1.f));
-	model = glm::scale(model, glm::vec3(size, 1.f));
-	
+void PetGame::SpriteRenderer::End()
+{
+	Submit();
+	m_instanceBuffer->EndFrame();
+	m_pointBuffer->EndFrame();
+}
+
+void PetGame::SpriteRenderer::DrawSprite(Texture2D* texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, SpriteLayer layer)
+{
+	Queue(texture, nullptr, position, size, rotate, color, glm::vec3(0.f), layer);
+}
 
-	m_shader.setMat4("model", model);
-	m_shader.setVec3("spriteColor", color);
+void PetGame::SpriteRenderer::DrawAnimation(SpriteAnimation* animation, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, float startTime, SpriteLayer layer)
+{
+	glm::vec3 animationData(0.f);
+	if (animation) {
+		animationData = glm::vec3((float)animation->getTickCount(), animation->getTickDuration(), startTime);
+	}
+	Queue(nullptr, animation, position, size, rotate, color, animationData, layer);
+}
 
-	glActiveTexture(GL_TEXTURE0);
-	texture->Bind();
+uint64_t PetGame::SpriteRenderer::MakeKey(SpriteLayer layer, float y, Program program, uint32_t material, size_t index)
+{
+	// Only objects are depth sorted, the other layers keep the depth bits equal and group by material
+	uint64_t depth = 0;
+	if (layer == SpriteLayer::Objects) {
+		// Higher y is further back and has to come first, so invert the ascending float order
+		depth = (~SortableFloat(y)) >> (32 - DEPTH_BITS);
+	}
+	uint64_t key = (uint64_t)layer;
+	key = (key << DEPTH_BITS) | depth;
+	key = (key << PROGRAM_BITS) | (uint64_t)program;
+	key = (key << MATERIAL_BITS) | material;
+	key = (key << INDEX_BITS) | index;
+	return key;
+}
 
-	glBindVertexArray(m_quadVAO);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
+uint32_t PetGame::SpriteRenderer::getMaterialId(const void* material)
+{
+	if (material == m_lastMaterial) {
+		return m_lastMaterialId;
+	}
+	auto found = m_materialIds.find(material);
+	if (found == m_materialIds.end()) {
+		// Ids only steer the grouping, starting over when they run out is harmless
+		if (m_materialIds.size() >= ((size_t)1 << MATERIAL_BITS)) {
+			m_materialIds.clear();
+		}
+		found = m_materialIds.emplace(material, (uint32_t)m_materialIds.size()).first;
+	}
+	m_lastMaterial = material;
+	m_lastMaterialId = found->second;
+	return m_lastMaterialId;
 }
 
-void PetGame::SpriteRenderer::DrawPet(const DigiPet::Pet* pet)
+void PetGame::SpriteRenderer::Queue(Texture2D* texture, SpriteAnimation* animation, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec3 animationData, SpriteLayer layer)
 {
-	this->DrawSprite(pet->getTexture(),pet->getPosition(),pet->getSize(),pet->getRotation(),pet->getColorTint());
+	if (m_cullEnabled) {
+		// Half the diagonal bounds the quad under any rotation, cheaper than transforming its corners
+		float radius = glm::length(size) * 0.5f;
+		if (position.x + radius < m_cullMin.x || position.x - radius > m_cullMax.x
+			|| position.y + radius < m_cullMin.y || position.y - radius > m_cullMax.y) {
+			s_spritesCulled.Add();
+			return;
+		}
+	}
+
+	float screenSize = glm::max(size.x, size.y) * m_pixelsPerUnit;
+	const SpriteLodAtlas::Entry* lod = (screenSize < m_mediumLodSize) ? FindLod(texture, animation) : nullptr;
+	// The index field of the key addresses at most MAX_COMMANDS, draw what we have and start over
+	if (m_keys.size() >= MAX_COMMANDS) {
+		Submit();
+	}
+
+	if (lod && screenSize < m_farLodSize) {
+		// Sized to the opaque area, rotation is not visible at this size
+		float pointSize = glm::max(screenSize * glm::sqrt(lod->coverage), 1.f);
+		m_keys.push_back(MakeKey(layer, position.y, Program::Point, 0, m_pointCommands.size()));
+		m_pointCommands.push_back({ position, pointSize, color * lod->averageColor });
+		s_spritesFarLod.Add();
+		return;
+	}
+	if (lod) {
+		texture = m_lodAtlas->getTexture();
+		animation = nullptr;
+		animationData = glm::vec3(0.f);
+		s_spritesMediumLod.Add();
+	}
+
+	uint32_t material = getMaterialId(animation ? (const void*)animation : (const void*)texture);
+	m_keys.push_back(MakeKey(layer, position.y, Program::Sprite, material, m_quadCommands.size()));
+	m_transforms.Add(size, rotate);
+	m_quadCommands.push_back({ texture, animation, { glm::vec4(0.f), position, color, animationData, lod ? lod->uvRect : FULL_UV_RECT } });
+}
+
+void PetGame::SpriteRenderer::Submit()
+{
+	RadixSort(m_keys, m_sortScratch, INDEX_BITS);
+	m_transforms.Build();
+
+	for (uint64_t key : m_keys) {
+		size_t index = (size_t)(key & (MAX_COMMANDS - 1));
+		Program program = (Program)((key >> (INDEX_BITS + MATERIAL_BITS)) & ((1 << PROGRAM_BITS) - 1));
+
+		if (program == Program::Point) {
+			if (!m_instances.empty()) {
+				Flush();
+			}
+			if (m_points.size() >= MAX_BATCH_POINTS) {
+				FlushPoints();
+			}
+			m_points.push_back(m_pointCommands[index]);
+			continue;
+		}
+
+		const QuadCommand& command = m_quadCommands[index];
+		if (!m_points.empty()) {
+			FlushPoints();
+		}
+		if (command.texture != m_batchTexture || command.animation != m_batchAnimation || m_instances.size() >= MAX_BATCH_INSTANCES) {
+			Flush();
+			m_batchTexture = command.texture;
+			m_batchAnimation = command.animation;
+		}
+		m_instances.push_back(command.instance);
+		m_instances.back().basis = m_transforms.getBasis(index);
+	}
+	Flush();
+	FlushPoints();
+
+	m_quadCommands.clear();
+	m_pointCommands.clear();
+	m_transforms.Clear();
+	m_keys.clear();
+}
+
+void PetGame::SpriteRenderer::Flush()
+{
+	if (m_instances.empty() || (!m_batchTexture && !m_batchAnimation)) {
+		m_instances.clear();
+		return;
+	}
+
+	size_t bytes = m_instances.size() * sizeof(InstanceData);
+	size_t offset = 0;
+	void* data = m_instanceBuffer->Map(bytes, offset);
+	if (!data) {
+		std::cout << "Failed to map sprite instance buffer" << std::endl;
+		m_instances.clear();
+		return;
+	}
+	std::memcpy(data, m_instances.data(), bytes);
+	m_instanceBuffer->Unmap();
+
+	Shader* shader = m_shaders.Get(m_shader);
+	if (!shader) {
+		m_instances.clear();
+		return;
+	}
+	shader->use();
+	if (m_batchAnimation) {
+		m_batchAnimation->Bind(FRAMES_UNIT, FRAME_TABLE_UNIT);
+	}
+	else {
+		GLState::ActiveTexture(TEXTURE_UNIT);
+		m_batchTexture->Bind();
+	}
+
+	// The VAO stays bound, nothing else in the frame edits vertex array state
+	GLState::BindVertexArray(m_quadVAO);
+
+	// Instances live at a different offset every batch, point the attributes at them
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer->getBuffer());
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, basis)));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, translation)));
+	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, color)));
+	glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, animation)));
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + offsetof(InstanceData, uvRect)));
+
+	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)m_instances.size());
+
+	s_spritesDrawn.Add(m_instances.size());
+	s_drawCalls.Add();
+	m_instances.clear();
+}
+
+const PetGame::SpriteLodAtlas::Entry* PetGame::SpriteRenderer::FindLod(Texture2D* texture, SpriteAnimation* animation)
+{
+	const void* source = animation ? (const void*)animation : (const void*)texture;
+	if (source != m_lodSource) {
+		m_lodSource = source;
+		m_lodEntry = animation ? m_lodAtlas->Find(animation) : m_lodAtlas->Find(texture);
+	}
+	return m_lodEntry;
+}
+
+void PetGame::SpriteRenderer::FlushPoints()
+{
+	if (m_points.empty()) {
+		return;
+	}
+
+	size_t bytes = m_points.size() * sizeof(PointData);
+	size_t offset = 0;
+	void* data = m_pointBuffer->Map(bytes, offset);
+	if (!data) {
+		std::cout << "Failed to map sprite point buffer" << std::endl;
+		m_points.clear();
+		return;
+	}
+	std::memcpy(data, m_points.data(), bytes);
+	m_pointBuffer->Unmap();
+
+	Shader* shader = m_shaders.Get(m_pointShader);
+	if (!shader) {
+		m_points.clear();
+		return;
+	}
+	shader->use();
+	GLState::BindVertexArray(m_pointVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_pointBuffer->getBuffer());
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(PointData), (void*)(offset + offsetof(PointData, position)));
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(PointData), (void*)(offset + offsetof(PointData, size)));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(PointData), (void*)(offset + offsetof(PointData, color)));
+
+	glDrawArrays(GL_POINTS, 0, (GLsizei)m_points.size());
+
+	s_spritesDrawn.Add(m_points.size());
+	s_drawCalls.Add();
+	m_points.clear();
+}
+
+void PetGame::SpriteRenderer::DrawSprite(const SpriteInstance& sprite)
+{
+	if (sprite.animation) {
+		this->DrawAnimation(sprite.animation, sprite.position, sprite.size, sprite.rotation, sprite.color, sprite.animationStart, sprite.layer);
+	}
+	else {
+		this->DrawSprite(sprite.texture, sprite.position, sprite.size, sprite.rotation, sprite.color, sprite.layer);
+	}
 }
 
 void PetGame::SpriteRenderer::Init()
@@ -60,7 +342,7 @@ void PetGame::SpriteRenderer::Init()
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
-	glBindVertexArray(m_quadVAO);
+	GLState::BindVertexArray(m_quadVAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
@@ -75,5 +357,29 @@ void PetGame::SpriteRenderer::Init()
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 5, (void*)(3 * sizeof(float)));
 	glEnableVertexAttribArray(1);
 
-	glBindVertexArray(0);
+	m_lodAtlas = std::make_unique<SpriteLodAtlas>();
+
+	// Instance attributes, the pointers are set on every flush
+	m_instanceBuffer = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, MAX_BATCH_INSTANCES * sizeof(InstanceData) * 4);
+	m_instances.reserve(MAX_BATCH_INSTANCES);
+	for (unsigned int location = 2; location <= 6; location++) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+
+	// Far LOD points, one vertex per pet sized by point.vert
+	glGenVertexArrays(1, &m_pointVAO);
+	GLState::BindVertexArray(m_pointVAO);
+	m_pointBuffer = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, MAX_BATCH_POINTS * sizeof(PointData) * 4);
+	m_points.reserve(MAX_BATCH_POINTS);
+	m_quadCommands.reserve(MAX_BATCH_INSTANCES);
+	m_transforms.Reserve(MAX_BATCH_INSTANCES);
+	m_keys.reserve(MAX_BATCH_INSTANCES);
+	m_sortScratch.reserve(MAX_BATCH_INSTANCES);
+	for (unsigned int location = 0; location <= 2; location++) {
+		glEnableVertexAttribArray(location);
+	}
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	GLState::BindVertexArray(0);
 }
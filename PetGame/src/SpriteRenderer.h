@@ -1,32 +1,171 @@
 #pragma once
-#include "Shader.h"
+#include "ShaderRegistry.h"
 #include "Texture2D.h"
+#include "SpriteAnimation.h"
 #include "glm/glm.hpp"
-#include "DigiPet.h"
+#include "RenderSnapshot.h"
+#include "StreamBuffer.h"
+#include "SpriteLodAtlas.h"
+#include "SpriteTransforms.h"
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 namespace PetGame {
+	/*
+		Sprites are queued between Begin and End, each with a 64 bit sort key of its layer, its depth,
+		its program and its texture. End radix sorts the keys and draws the sorted commands as instanced
+		batches, one batch per run of sprites sharing a texture or an animation, so the same sort gives
+		the right overlap and groups state changes. Instance data is streamed through a StreamBuffer.
+		Animated sprites pick their frame in sprite.vert, playing them costs no CPU work per frame.
+		Sprites outside the cull rect are rejected before any instance data is built for them.
+		Quads carry a 2D affine transform instead of a model matrix, Submit builds the transforms of
+		the whole frame at once with SpriteTransforms.
+		Small sprites drop to a level of detail picked from their size on screen: below the medium size
+		they are drawn from the SpriteLodAtlas, which every medium sprite shares, and below the far size as
+		a point of their average color. Points are a fraction of the instance data of a quad and sort next
+		to each other when the crowd is far, so a zoomed out crowd costs little more than its pet count.
+	*/
 	class SpriteRenderer
 	{
 	public:
-		SpriteRenderer(Shader& shader);
+		SpriteRenderer(ShaderRegistry& shaders, ShaderHandle shader, ShaderHandle pointShader);
 		~SpriteRenderer();
 
+		void Begin();
+		void End();
+
+		/* World rectangle that is visible this frame, usually from Camera2D::getVisibleRect*/
+		void setCullRect(glm::vec2 min, glm::vec2 max);
+		void disableCulling() { m_cullEnabled = false; };
+		/* Screen pixels per world unit this frame, what the LOD tiers are picked from*/
+		void setPixelsPerUnit(float pixelsPerUnit) { m_pixelsPerUnit = pixelsPerUnit; };
+		/* On screen sizes in pixels below which the medium and far tiers are used, a medium size of zero turns LOD off*/
+		void setLodSizes(float mediumSize, float farSize);
+		SpriteLodAtlas& getLodAtlas() { return *m_lodAtlas; };
+
 		void DrawSprite(
 			Texture2D* texture,
 			glm::vec2 position,
 			glm::vec2 size = glm::vec2(10.f, 10.f),
 			float rotate = 0,
-			glm::vec3 color = glm::vec3(1.f)
+			glm::vec3 color = glm::vec3(1.f),
+			SpriteLayer layer = SpriteLayer::Objects
+		);
+
+		/* startTime is when the animation started, in the same clock as the FrameData time*/
+		void DrawAnimation(
+			SpriteAnimation* animation,
+			glm::vec2 position,
+			glm::vec2 size = glm::vec2(10.f, 10.f),
+			float rotate = 0,
+			glm::vec3 color = glm::vec3(1.f),
+			float startTime = 0.f,
+			SpriteLayer layer = SpriteLayer::Objects
 		);
 
-		void DrawPet(const DigiPet::Pet* pet);
+		void DrawSprite(const SpriteInstance& sprite);
 
 	private:
-		Shader m_shader;
+		/* Per instance vertex attributes, locations 2 to 6 in sprite.vert*/
+		struct InstanceData {
+			/* Scaled x axis in xy and scaled y axis in zw, filled in by Submit*/
+			glm::vec4 basis;
+			glm::vec2 translation;
+			glm::vec3 color;
+			/* Tick count, tick duration and start time, zero ticks for static sprites*/
+			glm::vec3 animation;
+			/* Part of the texture to sample, offset and size*/
+			glm::vec4 uvRect;
+		};
+
+		/* Far LOD vertex, locations 0 to 2 in point.vert*/
+		struct PointData {
+			glm::vec2 position;
+			/* In screen pixels*/
+			float size;
+			glm::vec3 color;
+		};
+
+		/* Texture units used by sprite.vert and sprite.frag*/
+		static const unsigned int TEXTURE_UNIT = 0;
+		static const unsigned int FRAMES_UNIT = 1;
+		static const unsigned int FRAME_TABLE_UNIT = 2;
+
+		/* A quad queued for the sort, drawn with texture or animation. Its transform has the same index*/
+		struct QuadCommand {
+			Texture2D* texture;
+			SpriteAnimation* animation;
+			InstanceData instance;
+		};
+
+		/* Programs in sort key order*/
+		enum class Program : uint8_t {
+			Sprite,
+			Point,
+		};
+
+		/*
+			Sort key layout, most significant first:
+			layer 4 | depth 24 | program 2 | material 10 | command index 24
+			The index keeps submission order among equal sprites. Keys are pushed in index order and
+			the sort is stable, so the index bytes are never sorted on.
+		*/
+		static const int INDEX_BITS = 24;
+		static const int MATERIAL_BITS = 10;
+		static const int PROGRAM_BITS = 2;
+		static const int DEPTH_BITS = 24;
+		static const size_t MAX_COMMANDS = (size_t)1 << INDEX_BITS;
+
+		static const size_t MAX_BATCH_INSTANCES = 4096;
+		static const size_t MAX_BATCH_POINTS = 16384;
+
+		ShaderRegistry& m_shaders;
+		ShaderHandle m_shader;
 		unsigned int m_quadVAO;
 
+		std::unique_ptr<StreamBuffer> m_instanceBuffer;
+		std::vector<InstanceData> m_instances;
+		Texture2D* m_batchTexture;
+		SpriteAnimation* m_batchAnimation;
+
+		bool m_cullEnabled;
+		glm::vec2 m_cullMin;
+		glm::vec2 m_cullMax;
+
+		ShaderHandle m_pointShader;
+		unsigned int m_pointVAO;
+		std::unique_ptr<StreamBuffer> m_pointBuffer;
+		std::vector<PointData> m_points;
+
+		/* Commands of the frame and their keys, all kept between frames so sorting allocates nothing*/
+		std::vector<QuadCommand> m_quadCommands;
+		std::vector<PointData> m_pointCommands;
+		SpriteTransforms m_transforms;
+		std::vector<uint64_t> m_keys;
+		std::vector<uint64_t> m_sortScratch;
+		/* Small ids for textures and animations, so they fit the material field of the key*/
+		std::unordered_map<const void*, uint32_t> m_materialIds;
+		const void* m_lastMaterial;
+		uint32_t m_lastMaterialId;
+
+		std::unique_ptr<SpriteLodAtlas> m_lodAtlas;
+		/* Last atlas lookup, neighbouring sprites mostly share their image*/
+		const void* m_lodSource;
+		const SpriteLodAtlas::Entry* m_lodEntry;
+		float m_pixelsPerUnit;
+		float m_mediumLodSize;
+		float m_farLodSize;
+
 		void Init();
+		void Flush();
+		void FlushPoints();
+		const SpriteLodAtlas::Entry* FindLod(Texture2D* texture, SpriteAnimation* animation);
+		void Queue(Texture2D* texture, SpriteAnimation* animation, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec3 animationData, SpriteLayer layer);
+		/* Sorts and draws everything queued so far*/
+		void Submit();
+		uint32_t getMaterialId(const void* material);
+		static uint64_t MakeKey(SpriteLayer layer, float y, Program program, uint32_t material, size_t index);
 	};
 
 }
-
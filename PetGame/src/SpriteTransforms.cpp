@@ -0,0 +1,206 @@
+#include "SpriteTransforms.h"
+#include <cmath>
+#include "CpuFeatures.h"
+
+#if defined(PETGAME_X86)
+#include <immintrin.h>
+#endif
+
+namespace PetGame {
+	struct TransformArrays {
+		const float* width;
+		const float* height;
+		const float* rotation;
+		float* xAxisX;
+		float* xAxisY;
+		float* yAxisX;
+		float* yAxisY;
+	};
+
+	using TransformKernel = void(*)(const TransformArrays& arrays, size_t count);
+
+	/*
+		Sine and cosine of an angle in degrees. The angle is reduced to a quarter turn around zero
+		and evaluated with the single precision minimax polynomials from Cephes, every SIMD path runs
+		the same steps so all of them give the same result
+	*/
+	static const float QUARTERS_PER_DEGREE = 1.f / 90.f;
+	static const float RADIANS_PER_QUARTER = 1.57079632679489661923f;
+	static const float SIN_C3 = -1.6666654611e-1f;
+	static const float SIN_C5 = 8.3321608736e-3f;
+	static const float SIN_C7 = -1.9515295891e-4f;
+	static const float COS_C4 = 4.166664568298827e-2f;
+	static const float COS_C6 = -1.388731625493765e-3f;
+	static const float COS_C8 = 2.443315711809948e-5f;
+
+	static void SinCosDegrees(float degrees, float& sine, float& cosine)
+	{
+		float quarters = degrees * QUARTERS_PER_DEGREE;
+		float quadrant = std::nearbyint(quarters);
+		float x = (quarters - quadrant) * RADIANS_PER_QUARTER;
+		float x2 = x * x;
+		float s = x + x * x2 * (SIN_C3 + x2 * (SIN_C5 + x2 * SIN_C7));
+		float c = 1.f - 0.5f * x2 + x2 * x2 * (COS_C4 + x2 * (COS_C6 + x2 * COS_C8));
+
+		int q = (int)quadrant;
+		sine = (q & 1) ? c : s;
+		cosine = (q & 1) ? s : c;
+		sine = (q & 2) ? -sine : sine;
+		cosine = ((q + 1) & 2) ? -cosine : cosine;
+	}
+
+	static void BuildScalar(const TransformArrays& arrays, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++) {
+			float sine, cosine;
+			SinCosDegrees(arrays.rotation[i], sine, cosine);
+			arrays.xAxisX[i] = cosine * arrays.width[i];
+			arrays.xAxisY[i] = sine * arrays.width[i];
+			arrays.yAxisX[i] = -sine * arrays.height[i];
+			arrays.yAxisY[i] = cosine * arrays.height[i];
+		}
+	}
+
+	static void BuildKernelScalar(const TransformArrays& arrays, size_t count)
+	{
+		BuildScalar(arrays, 0, count);
+	}
+
+#if defined(PETGAME_X86)
+	PETGAME_TARGET("sse4.1")
+	static void BuildKernelSSE41(const TransformArrays& arrays, size_t count)
+	{
+		const __m128 signBit = _mm_set1_ps(-0.f);
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i two = _mm_set1_epi32(2);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 quarters = _mm_mul_ps(_mm_loadu_ps(arrays.rotation + i), _mm_set1_ps(QUARTERS_PER_DEGREE));
+			__m128 quadrant = _mm_round_ps(quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m128 x = _mm_mul_ps(_mm_sub_ps(quarters, quadrant), _mm_set1_ps(RADIANS_PER_QUARTER));
+			__m128 x2 = _mm_mul_ps(x, x);
+
+			__m128 s = _mm_add_ps(_mm_set1_ps(SIN_C5), _mm_mul_ps(x2, _mm_set1_ps(SIN_C7)));
+			s = _mm_add_ps(_mm_set1_ps(SIN_C3), _mm_mul_ps(x2, s));
+			s = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), s));
+			__m128 c = _mm_add_ps(_mm_set1_ps(COS_C6), _mm_mul_ps(x2, _mm_set1_ps(COS_C8)));
+			c = _mm_add_ps(_mm_set1_ps(COS_C4), _mm_mul_ps(x2, c));
+			c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), x2)), _mm_mul_ps(_mm_mul_ps(x2, x2), c));
+
+			// Odd quadrants swap sine and cosine, the sign bits come straight from the quadrant bits
+			__m128i q = _mm_cvtps_epi32(quadrant);
+			__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+			__m128 sine = _mm_blendv_ps(s, c, swap);
+			__m128 cosine = _mm_blendv_ps(c, s, swap);
+			__m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+			__m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+			sine = _mm_xor_ps(sine, sineSign);
+			cosine = _mm_xor_ps(cosine, cosineSign);
+
+			__m128 width = _mm_loadu_ps(arrays.width + i);
+			__m128 height = _mm_loadu_ps(arrays.height + i);
+			_mm_storeu_ps(arrays.xAxisX + i, _mm_mul_ps(cosine, width));
+			_mm_storeu_ps(arrays.xAxisY + i, _mm_mul_ps(sine, width));
+			_mm_storeu_ps(arrays.yAxisX + i, _mm_mul_ps(_mm_xor_ps(sine, signBit), height));
+			_mm_storeu_ps(arrays.yAxisY + i, _mm_mul_ps(cosine, height));
+		}
+		BuildScalar(arrays, i, count);
+	}
+
+	PETGAME_TARGET("avx2")
+	static void BuildKernelAVX2(const TransformArrays& arrays, size_t count)
+	{
+		const __m256 signBit = _mm256_set1_ps(-0.f);
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i two = _mm256_set1_epi32(2);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 quarters = _mm256_mul_ps(_mm256_loadu_ps(arrays.rotation + i), _mm256_set1_ps(QUARTERS_PER_DEGREE));
+			__m256 quadrant = _mm256_round_ps(quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256 x = _mm256_mul_ps(_mm256_sub_ps(quarters, quadrant), _mm256_set1_ps(RADIANS_PER_QUARTER));
+			__m256 x2 = _mm256_mul_ps(x, x);
+
+			__m256 s = _mm256_add_ps(_mm256_set1_ps(SIN_C5), _mm256_mul_ps(x2, _mm256_set1_ps(SIN_C7)));
+			s = _mm256_add_ps(_mm256_set1_ps(SIN_C3), _mm256_mul_ps(x2, s));
+			s = _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(x, x2), s));
+			__m256 c = _mm256_add_ps(_mm256_set1_ps(COS_C6), _mm256_mul_ps(x2, _mm256_set1_ps(COS_C8)));
+			c = _mm256_add_ps(_mm256_set1_ps(COS_C4), _mm256_mul_ps(x2, c));
+			c = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(_mm256_set1_ps(0.5f), x2)), _mm256_mul_ps(_mm256_mul_ps(x2, x2), c));
+
+			__m256i q = _mm256_cvtps_epi32(quadrant);
+			__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+			__m256 sine = _mm256_blendv_ps(s, c, swap);
+			__m256 cosine = _mm256_blendv_ps(c, s, swap);
+			__m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+			__m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+			sine = _mm256_xor_ps(sine, sineSign);
+			cosine = _mm256_xor_ps(cosine, cosineSign);
+
+			__m256 width = _mm256_loadu_ps(arrays.width + i);
+			__m256 height = _mm256_loadu_ps(arrays.height + i);
+			_mm256_storeu_ps(arrays.xAxisX + i, _mm256_mul_ps(cosine, width));
+			_mm256_storeu_ps(arrays.xAxisY + i, _mm256_mul_ps(sine, width));
+			_mm256_storeu_ps(arrays.yAxisX + i, _mm256_mul_ps(_mm256_xor_ps(sine, signBit), height));
+			_mm256_storeu_ps(arrays.yAxisY + i, _mm256_mul_ps(cosine, height));
+		}
+		BuildScalar(arrays, i, count);
+	}
+#endif
+
+	static TransformKernel SelectBuildKernel()
+	{
+#if defined(PETGAME_X86)
+		switch (getSimdLevel()) {
+		case SimdLevel::AVX2: return BuildKernelAVX2;
+		case SimdLevel::SSE41: return BuildKernelSSE41;
+		default: break;
+		}
+#endif
+		return BuildKernelScalar;
+	}
+
+	size_t SpriteTransforms::Add(glm::vec2 size, float rotation)
+	{
+		m_width.push_back(size.x);
+		m_height.push_back(size.y);
+		m_rotation.push_back(rotation);
+		return m_width.size() - 1;
+	}
+
+	void SpriteTransforms::Clear()
+	{
+		m_width.clear();
+		m_height.clear();
+		m_rotation.clear();
+	}
+
+	void SpriteTransforms::Reserve(size_t count)
+	{
+		for (std::vector<float>* values : { &m_width, &m_height, &m_rotation, &m_xAxisX, &m_xAxisY, &m_yAxisX, &m_yAxisY }) {
+			values->reserve(count);
+		}
+	}
+
+	void SpriteTransforms::Build()
+	{
+		static const TransformKernel kernel = SelectBuildKernel();
+
+		size_t count = getCount();
+		m_xAxisX.resize(count);
+		m_xAxisY.resize(count);
+		m_yAxisX.resize(count);
+		m_yAxisY.resize(count);
+
+		TransformArrays arrays;
+		arrays.width = m_width.data();
+		arrays.height = m_height.data();
+		arrays.rotation = m_rotation.data();
+		arrays.xAxisX = m_xAxisX.data();
+		arrays.xAxisY = m_xAxisY.data();
+		arrays.yAxisX = m_yAxisX.data();
+		arrays.yAxisY = m_yAxisY.data();
+		kernel(arrays, count);
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "glm/glm.hpp"
+
+namespace PetGame {
+	/*
+		Builds the 2D affine transforms of a frame of sprites in one pass. Sprites are added as a
+		structure of arrays and Build turns every rotation and size into the two basis vectors of the
+		sprite, several sprites per instruction with the widest SIMD path the CPU supports. The
+		translation is the position itself, so sprites only carry six floats instead of a mat4.
+	*/
+	class SpriteTransforms
+	{
+	public:
+		/* rotation in degrees, returns the index of the sprite*/
+		size_t Add(glm::vec2 size, float rotation);
+		void Clear();
+		void Reserve(size_t count);
+		size_t getCount() const { return m_width.size(); };
+
+		void Build();
+		/* Scaled x axis in xy and scaled y axis in zw, valid after Build*/
+		glm::vec4 getBasis(size_t i) const { return glm::vec4(m_xAxisX[i], m_xAxisY[i], m_yAxisX[i], m_yAxisY[i]); };
+
+	private:
+		std::vector<float> m_width;
+		std::vector<float> m_height;
+		std::vector<float> m_rotation;
+
+		std::vector<float> m_xAxisX;
+		std::vector<float> m_xAxisY;
+		std::vector<float> m_yAxisX;
+		std::vector<float> m_yAxisY;
+	};
+}
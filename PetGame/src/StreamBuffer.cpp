@@ -0,0 +1,112 @@
+#include "StreamBuffer.h"
+#include <glad/glad.h>
+#include "Profiler.h"
+
+namespace PetGame {
+	static ProfilerCounter s_bytesUploaded("Stream/Bytes uploaded", ProfilerCounter::Kind::PerFrame);
+	static ProfilerCounter s_mapCalls("Stream/Map calls", ProfilerCounter::Kind::PerFrame);
+	static ProfilerCounter s_fenceStalls("Stream/Fence stalls");
+	static ProfilerCounter s_orphans("Stream/Orphans");
+
+	StreamBuffer::StreamBuffer(unsigned int target, size_t regionSize, int regionCount, Mode mode)
+		: m_target(target),
+		m_buffer(0),
+		m_regionSize(regionSize),
+		m_regionCount(regionCount < 1 ? 1 : regionCount),
+		m_mode(mode),
+		m_region(0),
+		m_head(0),
+		m_regionReady(true),
+		m_fences(m_regionCount, nullptr)
+	{
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(m_target, m_buffer);
+		glBufferData(m_target, m_regionSize * m_regionCount, nullptr, GL_STREAM_DRAW);
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		for (void* fence : m_fences) {
+			if (fence) {
+				glDeleteSync((GLsync)fence);
+			}
+		}
+		glDeleteBuffers(1, &m_buffer);
+	}
+
+	void* StreamBuffer::Map(size_t size, size_t& offset)
+	{
+		if (size > m_regionSize) {
+			return nullptr;
+		}
+
+		glBindBuffer(m_target, m_buffer);
+		if (m_mode == Mode::Orphaning) {
+			// The whole buffer is one ring, on wrap the old storage is left to the driver
+			if (m_head + size > m_regionSize * m_regionCount) {
+				glBufferData(m_target, m_regionSize * m_regionCount, nullptr, GL_STREAM_DRAW);
+				m_head = 0;
+				s_orphans.Add();
+			}
+			offset = m_head;
+		}
+		else {
+			if (m_head + size > m_regionSize) {
+				// This frame outgrew its region, spill into the next one
+				AdvanceRegion();
+			}
+			if (!m_regionReady) {
+				WaitForRegion(m_region);
+			}
+			offset = m_region * m_regionSize + m_head;
+		}
+
+		void* data = glMapBufferRange(m_target, offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		m_head += (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+		s_bytesUploaded.Add(size);
+		s_mapCalls.Add();
+		return data;
+	}
+
+	void StreamBuffer::Unmap()
+	{
+		glBindBuffer(m_target, m_buffer);
+		glUnmapBuffer(m_target);
+	}
+
+	void StreamBuffer::EndFrame()
+	{
+		if (m_mode == Mode::Unsynchronized && m_head > 0) {
+			AdvanceRegion();
+		}
+	}
+
+	void StreamBuffer::AdvanceRegion()
+	{
+		if (m_fences[m_region]) {
+			glDeleteSync((GLsync)m_fences[m_region]);
+		}
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region = (m_region + 1) % m_regionCount;
+		m_head = 0;
+		m_regionReady = false;
+	}
+
+	void StreamBuffer::WaitForRegion(int region)
+	{
+		GLsync fence = (GLsync)m_fences[region];
+		if (fence) {
+			GLenum result = glClientWaitSync(fence, 0, 0);
+			if (result == GL_TIMEOUT_EXPIRED) {
+				// The GPU is still reading this region, block until it is done
+				s_fenceStalls.Add();
+				glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			}
+			glDeleteSync(fence);
+			m_fences[region] = nullptr;
+		}
+		m_regionReady = true;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace PetGame {
+	/*
+		Ring allocated buffer for data rewritten every frame. The buffer is split in one region per
+		frame in flight; a region is fenced when the frame moves on and only written again once
+		the GPU signalled that fence, so writes never wait on draws still reading the data.
+		Orphaning mode skips the fences and lets the driver hand out fresh storage on wrap instead.
+	*/
+	class StreamBuffer
+	{
+	public:
+		enum class Mode {
+			Unsynchronized,
+			Orphaning,
+		};
+
+		StreamBuffer(unsigned int target, size_t regionSize, int regionCount = 3, Mode mode = Mode::Unsynchronized);
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		/* Maps size bytes for writing, offset receives where they live in the buffer. Returns nullptr if size does not fit a region*/
+		void* Map(size_t size, size_t& offset);
+		void Unmap();
+
+		/* Call once all draws reading this frame's data were issued*/
+		void EndFrame();
+
+		unsigned int getBuffer() const { return m_buffer; };
+		size_t getRegionSize() const { return m_regionSize; };
+
+	private:
+		static const size_t ALIGNMENT = 16;
+
+		unsigned int m_target;
+		unsigned int m_buffer;
+		size_t m_regionSize;
+		int m_regionCount;
+		Mode m_mode;
+
+		int m_region;
+		size_t m_head;
+		bool m_regionReady;
+		std::vector<void*> m_fences;
+
+		void AdvanceRegion();
+		void WaitForRegion(int region);
+	};
+}
@@ -1,52 +1,163 @@
 #include "Texture2D.h"
 #include "stb_image.h"
-#include <glad/glad.h>
+#include <cstring>
+#include "GLState.h"
+#include "Profiler.h"
 #include <iostream>
 
-PetGame::Texture2D::Texture2D()
+typedef void (APIENTRYP PFN_TexStorage2D)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+
+namespace PetGame {
+	static ProfilerCounter s_textureMemory("Texture/Memory (bytes)", ProfilerCounter::Kind::Gauge);
+
+	// Not part of the GL 3.3 glad profile, loaded by hand
+	static PFN_TexStorage2D s_texStorage2D = nullptr;
+
+	static int MipLevels(int width, int height)
+	{
+		int levels = 1;
+		while ((width | height) >> levels) {
+			levels++;
+		}
+		return levels;
+	}
+
+	static int BytesPerPixel(unsigned int internalFormat)
+	{
+		switch (internalFormat) {
+		case GL_R8: return 1;
+		case GL_RGB8: return 3;
+		default: return 4;
+		}
+	}
+}
+
+PetGame::Texture2D::Texture2D(TexturePreset preset)
 	:m_width(0),
 	m_height(0),
-	m_internalFormat(GL_RGBA),
+	m_internalFormat(GL_RGBA8),
 	m_imageFormat(GL_RGBA),
-	m_wrapS(GL_REPEAT),
-	m_wrapT(GL_REPEAT),
-	m_filterMin(GL_NEAREST_MIPMAP_LINEAR),
-	m_filterMax(GL_NEAREST)
+	m_storageFormat(0),
+	m_storageBytes(0)
 {
+	ApplyPreset(preset);
 	glGenTextures(1, &ID);
 }
 
 
 PetGame::Texture2D::~Texture2D()
 {
+	s_textureMemory.Add(-m_storageBytes);
+	GLState::ForgetTexture(ID);
+	glDeleteTextures(1, &ID);
 }
 
-void PetGame::Texture2D::Generate(int width, int height, unsigned char* data)
+bool PetGame::Texture2D::Init(GLADloadproc load)
 {
+	s_texStorage2D = nullptr;
+
+	// Loaders hand out pointers for functions the driver does not implement, check the version first
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	bool supported = major > 4 || (major == 4 && minor >= 2);
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (GLint i = 0; i < extensionCount && !supported; i++) {
+		supported = std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_texture_storage") == 0;
+	}
+
+	if (supported) {
+		s_texStorage2D = (PFN_TexStorage2D)load("glTexStorage2D");
+	}
+	if (!s_texStorage2D) {
+		std::cout << "Immutable texture storage not supported, using glTexImage2D" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void PetGame::Texture2D::ApplyPreset(TexturePreset preset)
+{
+	switch (preset) {
+	case TexturePreset::PixelArt:
+		m_wrapS = m_wrapT = GL_CLAMP_TO_EDGE;
+		m_filterMin = GL_NEAREST;
+		m_filterMax = GL_NEAREST;
+		m_mipmaps = false;
+		break;
+	case TexturePreset::UI:
+		m_wrapS = m_wrapT = GL_CLAMP_TO_EDGE;
+		m_filterMin = GL_LINEAR;
+		m_filterMax = GL_LINEAR;
+		m_mipmaps = false;
+		break;
+	case TexturePreset::Filtered:
+		m_wrapS = m_wrapT = GL_REPEAT;
+		m_filterMin = GL_LINEAR_MIPMAP_LINEAR;
+		m_filterMax = GL_LINEAR;
+		m_mipmaps = true;
+		break;
+	}
+}
+
+void PetGame::Texture2D::Generate(int width, int height, const unsigned char* data)
+{
+	if (!data)
+	{
+		std::cout << "Failed to load texture" << std::endl;
+		return;
+	}
+
+	int levels = m_mipmaps ? MipLevels(width, height) : 1;
+	GLState::BindTexture(GL_TEXTURE_2D, ID);
+	// stb_image rows are tightly packed, which breaks the default 4 byte alignment for odd RGB widths
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	if (s_texStorage2D) {
+		if (m_storageFormat != 0 && (width != m_width || height != m_height || m_internalFormat != m_storageFormat)) {
+			// Immutable storage cannot be resized, start over with a new name
+			GLState::ForgetTexture(ID);
+			glDeleteTextures(1, &ID);
+			glGenTextures(1, &ID);
+			GLState::BindTexture(GL_TEXTURE_2D, ID);
+			m_storageFormat = 0;
+		}
+		if (m_storageFormat == 0) {
+			s_texStorage2D(GL_TEXTURE_2D, levels, m_internalFormat, width, height);
+			m_storageFormat = m_internalFormat;
+		}
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, m_imageFormat, GL_UNSIGNED_BYTE, data);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, width, height, 0, m_imageFormat, GL_UNSIGNED_BYTE, data);
+	}
 	m_width = width;
 	m_height = height;
 
-	glBindTexture(GL_TEXTURE_2D, ID);
-
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_wrapS);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_wrapT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_filterMin);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_filterMax);
-
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, m_width, m_height, 0, m_imageFormat, GL_UNSIGNED_BYTE, data);
+	// Without this a mutable texture with one level would be incomplete for mipmapped filters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	if (m_mipmaps) {
 		glGenerateMipmap(GL_TEXTURE_2D);
 	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
+
+	long long bytes = 0;
+	for (int level = 0; level < levels; level++) {
+		int levelWidth = (width >> level) > 0 ? (width >> level) : 1;
+		int levelHeight = (height >> level) > 0 ? (height >> level) : 1;
+		bytes += (long long)levelWidth * levelHeight * BytesPerPixel(m_internalFormat);
 	}
+	s_textureMemory.Add(bytes - m_storageBytes);
+	m_storageBytes = bytes;
 }
 
 void PetGame::Texture2D::Bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, ID);
+	GLState::BindTexture(GL_TEXTURE_2D, ID);
 }
 
 bool PetGame::Texture2D::Load(const char* filePath)
@@ -56,25 +167,12 @@ bool PetGame::Texture2D::Load(const char* filePath)
 	unsigned char* data = stbi_load(filePath, &width, &height, &nrChannels, 0);
 	std::cout << "Loading " << filePath << std::endl;
 	if (data) {
-
-		GLenum format;
-		if (nrChannels == 1)
-			format = GL_RED;
-		else if (nrChannels == 3)
-			format = GL_RGB;
-		else if (nrChannels == 4)
-			format = GL_RGBA;
-		else
-		{
+		bool uploaded = Upload(width, height, nrChannels, data);
+		if (!uploaded) {
 			std::cout << "Texture format not supported for " << filePath << std::endl;
-			return false;
-			stbi_image_free(data);
 		}
-		m_internalFormat = format;
-		m_imageFormat = format;
-		Generate(width, height, data);
 		stbi_image_free(data);
-		return true;
+		return uploaded;
 	}
 	else {
 		std::cout << "Texture failed to load at path: " << filePath << std::endl;
@@ -83,10 +181,43 @@ bool PetGame::Texture2D::Load(const char* filePath)
 
 }
 
-std::unique_ptr<PetGame::Texture2D> PetGame::Texture2D::CreateTexture(const char* filePath)
+bool PetGame::Texture2D::Upload(int width, int height, int channels, const unsigned char* data)
+{
+	if (channels == 1) {
+		m_internalFormat = GL_R8;
+		m_imageFormat = GL_RED;
+	}
+	else if (channels == 3) {
+		m_internalFormat = GL_RGB8;
+		m_imageFormat = GL_RGB;
+	}
+	else if (channels == 4) {
+		m_internalFormat = GL_RGBA8;
+		m_imageFormat = GL_RGBA;
+	}
+	else
+		return false;
+
+	Generate(width, height, data);
+	return true;
+}
+
+bool PetGame::Texture2D::ReadPixels(std::vector<unsigned char>& rgba) const
+{
+	if (m_width <= 0 || m_height <= 0) {
+		return false;
+	}
+	rgba.resize((size_t)m_width * m_height * 4);
+	GLState::BindTexture(GL_TEXTURE_2D, ID);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+	return true;
+}
+
+std::unique_ptr<PetGame::Texture2D> PetGame::Texture2D::CreateTexture(const char* filePath, TexturePreset preset)
 {
 	std::cout << "Creating unique" << std::endl;
-	std::unique_ptr<PetGame::Texture2D> texture = std::make_unique<PetGame::Texture2D>();
+	std::unique_ptr<PetGame::Texture2D> texture = std::make_unique<PetGame::Texture2D>(preset);
 	texture->Load(filePath);
 	return texture;
 }
@@ -1,13 +1,28 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <glad/glad.h>
 namespace PetGame {
+	/* Sampling and storage settings picked when a texture is created*/
+	enum class TexturePreset {
+		/* Nearest filtering, clamped, no mipmaps. Sprites drawn at integer scale never sample a mip*/
+		PixelArt,
+		/* Linear filtering, clamped, no mipmaps*/
+		UI,
+		/* Trilinear filtering, repeating, full mip chain*/
+		Filtered,
+	};
+
 	class Texture2D
 	{
 	public:
-		Texture2D();
+		Texture2D(TexturePreset preset = TexturePreset::PixelArt);
 		~Texture2D();
 
+		/* Needs a current context, enables immutable storage (GL 4.2 / ARB_texture_storage) when available*/
+		static bool Init(GLADloadproc load);
+
 		unsigned int ID;
 		int m_width, m_height;
 		unsigned int m_internalFormat;
@@ -17,17 +32,29 @@ namespace PetGame {
 		unsigned int m_wrapT;
 		unsigned int m_filterMin;
 		unsigned int m_filterMax;
+		bool m_mipmaps;
 
 
 		void Bind() const;
 
 		bool Load(const char* filePath);
-
-		static std::unique_ptr<PetGame::Texture2D> CreateTexture(const char* filePath);
+		/*
+			Replaces the image in place, holders of this texture keep working. The GL name only changes
+			when immutable storage has to be reallocated for a new size or format
+		*/
+		bool Upload(int width, int height, int channels, const unsigned char* data);
+		/* Copies the base level back from GL as RGBA8, bottom row first. Slow, meant for one time processing*/
+		bool ReadPixels(std::vector<unsigned char>& rgba) const;
+
+		static std::unique_ptr<PetGame::Texture2D> CreateTexture(const char* filePath, TexturePreset preset = TexturePreset::PixelArt);
 	private:
-		void Generate(int width, int height, unsigned char* data);
+		/* Internal format of the immutable storage, zero while none was allocated*/
+		unsigned int m_storageFormat;
+		long long m_storageBytes;
+
+		void Generate(int width, int height, const unsigned char* data);
+		void ApplyPreset(TexturePreset preset);
 
 	};
 
 }
-
@@ -0,0 +1,50 @@
+#include "TextureCache.h"
+#include "AllocationCounter.h"
+
+namespace PetGame {
+	Texture2D* TextureCache::Load(const std::string& filePath, TexturePreset preset)
+	{
+		Texture2D* existing = Find(filePath);
+		if (existing) {
+			return existing;
+		}
+
+		AllocationScope allocationScope(AllocationTag::Assets);
+		std::unique_ptr<Texture2D> texture = Texture2D::CreateTexture(filePath.c_str(), preset);
+		Texture2D* result = texture.get();
+		m_textures[filePath] = std::move(texture);
+		return result;
+	}
+
+	Texture2D* TextureCache::Find(const std::string& filePath) const
+	{
+		auto entry = m_textures.find(filePath);
+		if (entry == m_textures.end()) {
+			return nullptr;
+		}
+		return entry->second.get();
+	}
+
+	SpriteAnimation* TextureCache::LoadAnimation(const std::string& filePath)
+	{
+		SpriteAnimation* existing = FindAnimation(filePath);
+		if (existing) {
+			return existing;
+		}
+
+		AllocationScope allocationScope(AllocationTag::Assets);
+		std::unique_ptr<SpriteAnimation> animation = SpriteAnimation::CreateAnimation(filePath.c_str());
+		SpriteAnimation* result = animation.get();
+		m_animations[filePath] = std::move(animation);
+		return result;
+	}
+
+	SpriteAnimation* TextureCache::FindAnimation(const std::string& filePath) const
+	{
+		auto entry = m_animations.find(filePath);
+		if (entry == m_animations.end()) {
+			return nullptr;
+		}
+		return entry->second.get();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include "Texture2D.h"
+#include "SpriteAnimation.h"
+
+namespace PetGame {
+	/*
+		Sole owner of the textures and animations loaded from disk, keyed by path. Pets and sprites keep plain
+		Texture2D pointers, which stay valid until the cache is destroyed, even across reloads.
+		Only used from the thread that owns the GL context.
+	*/
+	class TextureCache
+	{
+	public:
+		TextureCache() = default;
+		~TextureCache() = default;
+
+		TextureCache(const TextureCache&) = delete;
+		TextureCache& operator=(const TextureCache&) = delete;
+
+		/* Loads the file the first time a path is seen, later calls return the same texture whatever the preset*/
+		Texture2D* Load(const std::string& filePath, TexturePreset preset = TexturePreset::PixelArt);
+		Texture2D* Find(const std::string& filePath) const;
+
+		SpriteAnimation* LoadAnimation(const std::string& filePath);
+		SpriteAnimation* FindAnimation(const std::string& filePath) const;
+
+		void Clear() { m_textures.clear(); m_animations.clear(); };
+
+	private:
+		std::map<std::string, std::unique_ptr<Texture2D>> m_textures;
+		std::map<std::string, std::unique_ptr<SpriteAnimation>> m_animations;
+	};
+}
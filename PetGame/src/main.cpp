@@ -1,4 +1,7 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include "Application.h"
 #include "DigiPet.h"
 
@@ -7,12 +10,48 @@ enum SCREEN {
 	HEIGHT = 600
 };
 
-int main() {
+int main(int argc, char** argv) {
 	PetGame::Application game = PetGame::Application();
+	game.setFramePacing(PetGame::VSyncMode::On, 60.f);
+
+	// --headless <frames> [--capture <directory>] renders without a window, e.g. for benchmarks and golden images
+	// --pets <count> [--zoom <zoom>] fills the world with more pets and zooms out over them, e.g. to measure culling and LOD
+	// --allocation-budget <count> fails a headless run when a frame makes more heap allocations, e.g. in CI
+	int headlessFrames = 0;
+	int petCount = 1;
+	float zoom = 1.f;
+	int allocationBudget = -1;
+	std::string captureDirectory;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+			headlessFrames = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			captureDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--pets") == 0 && i + 1 < argc) {
+			petCount = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--zoom") == 0 && i + 1 < argc) {
+			zoom = (float)std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--allocation-budget") == 0 && i + 1 < argc) {
+			allocationBudget = std::atoi(argv[++i]);
+		}
+	}
+	game.setPetCount(petCount);
+	game.setCameraZoom(zoom);
+	if (allocationBudget >= 0) {
+		game.setFrameAllocationBudget(allocationBudget);
+	}
+	if (headlessFrames > 0) {
+		game.setHeadless(headlessFrames, captureDirectory);
+	}
 
 	if (game.Init(SCREEN::WIDTH, SCREEN::HEIGHT, "Tamagochi")) {
 		game.Start();
 	}
 
 	game.Stop();
+	return game.isAllocationBudgetExceeded() ? EXIT_FAILURE : EXIT_SUCCESS;
 }